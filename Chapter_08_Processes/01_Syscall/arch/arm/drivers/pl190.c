@@ -27,10 +27,22 @@ arch_ic_t pl190 = (arch_ic_t)
 };
 
 
+/*
+ * Vectored interrupts: sources from this list (by priority) get vectored
+ * slots; vector address is set to interrupt number, so VICVECTADDR gives
+ * highest priority active request with single read. Other sources are
+ * found from status register (VICDEFVECTADDR is 0).
+ */
+static uint8 vic_prio[] = {
+	TIMER01, TIMER23, UART0IRQL, UART1IRQL, UART2IRQL, RTC, SSP, DMA,
+	GPIO0, GPIO1, GPIO2, GPIO3, SCI0, CLCD, VICINTSOURCE31, WATCHDOG
+};
+
 /*! Initialize VIC */
 static void pl190_init()
 {
 	volatile uint32 *vicreg;
+	int i;
 
 	/* disable all interrupts */
 	vicreg = (void *)(VICBASE + VICINTENABLE);
@@ -48,6 +60,22 @@ static void pl190_init()
 	vicreg = (void *)(VICBASE + VICPROTECTION);
 	*vicreg = 0;
 
+	/* vectored slots */
+	for (i = 0; i < VICVECTS && i < sizeof(vic_prio); i++)
+	{
+		vicreg = (void *)(VICBASE + VICVECTADDR0 + i * 4);
+		*vicreg = vic_prio[i] + IRQ_OFFSET;
+
+		vicreg = (void *)(VICBASE + VICVECTCNTL0 + i * 4);
+		*vicreg = VICVECT_ENABLE | vic_prio[i];
+	}
+	vicreg = (void *)(VICBASE + VICDEFVECTADDR);
+	*vicreg = 0;
+
+	/* clear any interrupt left "in service" */
+	vicreg = (void *)(VICBASE + VICVECTADDR);
+	*vicreg = 0;
+
 	/* PIC initialized, all external interrupts disabled */
 }
 
@@ -96,17 +124,29 @@ static void pl190_irq_disable(unsigned int irq)
 }
 
 /*!
- * At end of interrupt processing, re enable some ports in VIC
+ * At end of interrupt processing, re enable some ports in VIC: writing
+ * VICVECTADDR ends service of current vectored interrupt (lower priority
+ * requests are masked by VIC until then)
  * \param irq Interrupt request number
  */
 static void pl190_at_exit(unsigned int irq)
 {
+	volatile uint32 *vicreg;
+
+	vicreg = (void *)(VICBASE + VICVECTADDR);
+	*vicreg = 0;
 }
 
 static int pl190_get_irq()
 {
 	volatile uint32 *vicreg, mask, irq;
 
+	/* vectored request with highest priority, 0 if none */
+	vicreg = (void *)(VICBASE + VICVECTADDR);
+	irq = *vicreg;
+	if (irq)
+		return irq;
+
 	vicreg = (void *)(VICBASE + VICIRQSTATUS);
 
 	mask = *vicreg;
@@ -27,7 +27,6 @@
 #define VICSOFTINTCLEAR	0x01C /* WO   -            Software Int. Clear Reg. */
 #define VICPROTECTION	0x020 /* R/W  0x0          Protection Enable Reg. */
 
-#if 0	/*! Not using vectored interrupts !*/
 #define VICVECTADDR	0x030 /* R/W  0x00000000   Vector Address Reg. */
 #define VICDEFVECTADDR	0x034 /* R/W  0x00000000   Default Vector Address Reg. */
 
@@ -37,7 +36,9 @@
 #define VICVECTCNTL0	0x200 /* R/W	0x00000000 Vector Control Reg.s */
 /* ... */
 #define VICVECTCNTL15	0x23c /* R/W	0x00000000 Vector Control Reg.s */
-#endif
+
+#define VICVECTS	16	/* vectored slots; slot 0 - highest priority */
+#define VICVECT_ENABLE	(1 << 5) /* in VICVECTCNTLn, with source in bits 0-4 */
 
 
 /*! Interrupts generated through VIC (connected to VIC) */
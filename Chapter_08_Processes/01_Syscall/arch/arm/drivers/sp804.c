@@ -14,8 +14,12 @@ static void sp804_disable_interrupt();
 static void sp804_register_interrupt(void *handler);
 static void sp804_set_time_to_counter(timespec_t *time);
 static void sp804_get_time_from_counter(timespec_t *time);
+static void sp804_get_clock(timespec_t *time);
 static void (*sp804_handler)();
 
+static uint64 clock_count;	/* timer1 ticks since init (extended to 64b) */
+static uint32 clock_last;	/* timer1 value on last read */
+
 
 /*! timer device sp804, wrapper for arch_timer_t interface */
 arch_timer_t sp804 = (arch_timer_t)
@@ -25,13 +29,17 @@ arch_timer_t sp804 = (arch_timer_t)
 	.init = sp804_init,
 	.set_interval = sp804_set_time_to_counter,
 	.get_interval_remainder = sp804_get_time_from_counter,
+	.get_clock = sp804_get_clock,
 	.enable_interrupt = sp804_enable_interrupt,
 	.disable_interrupt = sp804_disable_interrupt,
 	.register_interrupt = sp804_register_interrupt
 };
 /* accessed from 'arch' layer via: extern arch_timer_t sp804 */
 
-/*! Calculate min and max counting interval, and set initial counter */
+/*!
+ * Calculate min and max counting interval, start clock source (timer1) and
+ * prepare event timer (timer0)
+ */
 static void sp804_init()
 {
 	volatile uint32 *ptr;
@@ -39,17 +47,22 @@ static void sp804_init()
 	sp804_handler = NULL;
 
 	COUNT_TO_TIME(ISP804_COUNT_MIN, &sp804.min_interval);
-	COUNT_TO_TIME(ISP804_COUNT_MAX, &sp804.max_interval);
+	COUNT_TO_TIME(ISP804_ONESHOT_MAX, &sp804.max_interval);
 
-	/* disable interrupt generation on timer1 */
+	/* timer1: free running (wraps from 0 to 0xffffffff), no interrupts */
 	ptr = (uint32 *)(TIMER1_BASE + TIMER_CONTROL);
-	*ptr = *ptr &(~TIMER_INT_ENABLE);
+	*ptr = TIMER_SIZE_32;
+	*((volatile uint32 *)(TIMER1_BASE + TIMER_LOAD)) = ISP804_COUNT_MAX;
+	*ptr = TIMER_ENABLE | TIMER_SIZE_32;
+
+	clock_count = 0;
+	clock_last = ISP804_COUNT_MAX;
 
-	/* set parameters for timer0 */
+	/* timer0: one shot; (re)started with each write to load register */
 	ptr = (uint32 *)(TIMER0_BASE + TIMER_CONTROL);
-	*ptr = TIMER_SIZE_32;
-	sp804_set(ISP804_COUNT_MAX);
-	*ptr = TIMER_ENABLE | TIMER_MODE_PERIODIC | TIMER_SIZE_32;
+	*ptr = TIMER_SIZE_32 | TIMER_ONESHOT;
+	sp804_set(ISP804_ONESHOT_MAX);
+	*ptr = TIMER_ENABLE | TIMER_ONESHOT | TIMER_SIZE_32;
 	/* just don't generate interrupts yet */
 
 	/* enable interrupt on VIC */
@@ -100,6 +113,24 @@ static void sp804_get_time_from_counter(timespec_t *time)
 	COUNT_TO_TIME(cnt, time);
 }
 
+/*!
+ * Read clock source (timer1) and convert ticks since init into 'time';
+ * counter wraps around every 2^32 us - it must be read more often than that
+ */
+static void sp804_get_clock(timespec_t *time)
+{
+	uint32 cnt;
+
+	ASSERT(time);
+
+	cnt = *((volatile uint32 *)(TIMER1_BASE + TIMER_VALUE));
+
+	clock_count += (uint32) (clock_last - cnt); /* counts down */
+	clock_last = cnt;
+
+	COUNT64_TO_TIME(clock_count, time);
+}
+
 /*! Enable counter interrupts */
 static void sp804_enable_interrupt()
 {
@@ -12,7 +12,10 @@ typedef struct _arch_timer_t_
 
 	void (*init)();
 	void (*set_interval)(timespec_t *);
+		/* one shot: single interrupt after given interval */
 	void (*get_interval_remainder)(timespec_t *);
+	void (*get_clock)(timespec_t *);
+		/* free running clock: time since init */
 	void (*enable_interrupt)();
 	void (*disable_interrupt)();
 	void (*register_interrupt)(void *handler);
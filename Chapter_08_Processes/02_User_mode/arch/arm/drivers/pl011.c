@@ -1,4 +1,12 @@
-/*! Print on console using ARM PrimeCell UART (PL011) [simple mode!] */
+/*! Print on console using ARM PrimeCell UART (PL011) */
+
+/*
+ * Both 16 byte FIFOs are used. Data goes through software buffers: send
+ * fills transmit FIFO and returns; rest is moved to FIFO from interrupt
+ * handler when FIFO drops to UART_TX_LEVEL. Received data is moved to
+ * software buffer when receive FIFO reaches UART_RX_LEVEL, or on receive
+ * timeout (when fewer bytes arrived and line is idle).
+ */
 
 #ifdef PL011
 
@@ -23,7 +31,7 @@ static int  uart_recv(void *data, size_t size, uint flags, device_t *dev);
 static int uart_init(uint flags, void *params, device_t *dev)
 {
 	volatile unsigned int *uart_ibrd, *uart_fbrd;
-	volatile unsigned int *uart_lcr_h, *uart_cr, *uart_imsc;
+	volatile unsigned int *uart_lcr_h, *uart_cr, *uart_imsc, *uart_ifls;
 	arch_uart_t *up;
 
 	ASSERT(dev);
@@ -35,13 +43,15 @@ static int uart_init(uint flags, void *params, device_t *dev)
 	uart_lcr_h = (unsigned int *)(up->base + UART_LCR_H);
 	uart_cr = (unsigned int *)(up->base + UART_CR);
 	uart_imsc = (unsigned int *)(up->base + UART_IMSC);
+	uart_ifls = (unsigned int *)(up->base + UART_IFLS);
 
 	*uart_cr = 0;
 
 	*uart_ibrd = UART_IBRD_V;
 	*uart_fbrd = UART_FBRD_V;
-	*uart_lcr_h = UART_LCR_H_WL; /* not using FIFO! */
-	*uart_imsc = UART_IMSC_RXIM | UART_IMSC_TXIM;
+	*uart_lcr_h = UART_LCR_H_WL | UART_LCR_H_FEN;
+	*uart_ifls = UART_IFLS_V(UART_RX_LEVEL, UART_TX_LEVEL);
+	*uart_imsc = UART_IMSC_RXIM | UART_IMSC_RTIM | UART_IMSC_TXIM;
 
 	*uart_cr = UART_CR_RXE | UART_CR_TXE | UART_CR_UARTEN;
 
@@ -67,30 +77,37 @@ static int uart_destroy(uint flags, void *params, device_t *dev)
 /*! Interrupt handler for UART device */
 static int uart_interrupt_handler(int irq_num, void *dev)
 {
-	volatile unsigned int *uart_icr;
+	volatile unsigned int *uart_icr, *uart_mis;
 	device_t *uart = dev;
 	arch_uart_t *up;
+	uint mis;
 
 	ASSERT(dev);
 
 	up = uart->params;
 
-	/* not checking for errors; just get received character to software
-	 * buffer and send next from send buffer if previous is sent */
-
-	/* clear interrupts */
+	uart_mis = (unsigned int *)(up->base + UART_MIS);
 	uart_icr = (unsigned int *)(up->base + UART_ICR);
-	*uart_icr = UART_IMSC_RXIM | UART_IMSC_TXIM;
 
-	/* "synchronize" UART with software buffer */
-	uart_write(uart->params);
-	uart_read(uart->params);
+	/* clear interrupts; FIFOs are handled below */
+	mis = *uart_mis;
+	*uart_icr = mis;
+
+	if (mis & (UART_IMSC_RXIM | UART_IMSC_RTIM))
+		uart_read(up);
+
+	if (mis & UART_IMSC_TXIM)
+		uart_write(up);
+
+	/* notify kernel: data arrived or space in buffer is available */
+	if (mis && uart->callback)
+		uart->callback(irq_num, uart);
 
 	return 0;
 }
 
 
-/*! If there is data in software buffer, send it to UART */
+/*! If there is data in software buffer, move it to UART FIFO */
 static void uart_write(arch_uart_t *up)
 {
 	volatile unsigned int *uart_dr;
@@ -101,7 +118,7 @@ static void uart_write(arch_uart_t *up)
 	uart_dr = (unsigned int *)(up->base + UART_DR);
 	uart_fr = (unsigned int *)(up->base + UART_FR);
 
-	/* If UART is ready to transmit and software buffer is not empty */
+	/* While transmit FIFO is not full and software buffer is not empty */
 	while (up->outsz > 0 && ((*uart_fr) & UART_FR_TXFF) == 0)
 	{
 		*uart_dr = (unsigned int) up->outbuff[up->outf];
@@ -141,21 +158,33 @@ static int uart_send(void *data, size_t size, uint flags, device_t *dev)
 	return size; /* 0 if all sent, otherwise not send part length */
 }
 
-/*! Read data from UART to software buffer */
+/*!
+ * Read data from UART FIFO to software buffer; whole FIFO is emptied (if
+ * software buffer is full, rest is dropped) so that receive interrupt is
+ * not raised again for same data
+ */
 static void uart_read(arch_uart_t *up)
 {
 	volatile unsigned int *uart_dr;
 	volatile unsigned int *uart_fr;
+	uint data;
 
 	ASSERT(up);
 
-	uart_dr = (unsigned int *)(UART0_BASE + UART_DR);
-	uart_fr = (unsigned int *)(UART0_BASE + UART_FR);
+	uart_dr = (unsigned int *)(up->base + UART_DR);
+	uart_fr = (unsigned int *)(up->base + UART_FR);
 
-	/* While UART is not empty and software buffer is not full */
-	while (((*uart_fr) & UART_FR_RXFE) == 0 && up->insz < up->inbufsz)
+	while (((*uart_fr) & UART_FR_RXFE) == 0)
 	{
-		up->inbuff[up->inl] = *uart_dr;
+		data = *uart_dr;
+
+		if ((data & DR_ERR_MASK) || up->insz == up->inbufsz)
+		{
+			up->rx_dropped++;
+			continue;
+		}
+
+		up->inbuff[up->inl] = (uint8) data;
 		INC_MOD(up->inl, up->inbufsz);
 		up->insz++;
 	}
@@ -219,7 +248,8 @@ static arch_uart_t uart0_params = (arch_uart_t)
 	.inbuff = uart0_inbuf,
 	.inbufsz=BUFFER_SIZE, .inf = 0, .inl = 0, .insz = 0,
 	.outbuff = uart0_outbuf,
-	.outbufsz=BUFFER_SIZE, .outf = 0, .outl = 0, .outsz = 0
+	.outbufsz=BUFFER_SIZE, .outf = 0, .outl = 0, .outsz = 0,
+	.rx_dropped = 0
 };
 
 /*! uart0 as device_t -----------------------------------------------------*/
@@ -38,9 +38,24 @@
 #define UART_CR_TXE	0x10	/* Transmit enable */
 #define UART_CR_UARTEN	0x01	/* UART enable */
 
+#define UART_IMSC_RTIM	0x40	/* Receive timeout interrupt */
 #define UART_IMSC_TXIM	0x20	/* Transmit interrupt */
 #define UART_IMSC_RXIM	0x10	/* Receive interrupt */
 
+/* FIFO levels for interrupts (FIFOs are 16 bytes deep) */
+#define UART_IFLS_1_8	0	/* 2 bytes */
+#define UART_IFLS_1_4	1	/* 4 bytes */
+#define UART_IFLS_1_2	2	/* 8 bytes */
+#define UART_IFLS_3_4	3	/* 12 bytes */
+#define UART_IFLS_7_8	4	/* 14 bytes */
+#define UART_IFLS_V(RX, TX)	(((RX) << 3) | (TX))
+
+/* transmit interrupt when FIFO drops to 2 bytes (refill it before it empties),
+ * receive interrupt at 8 bytes (or on timeout, for fewer bytes) */
+#define UART_TX_LEVEL	UART_IFLS_1_8
+#define UART_RX_LEVEL	UART_IFLS_1_2
+
+#define UART_FR_TXFE	(1<<7)	/* Transmit FIFO empty */
 #define UART_FR_TXFF	(1<<5)	/* Transmit FIFO full */
 #define UART_FR_RXFE	(1<<4)	/* Receive FIFO empty */
 
@@ -70,6 +85,8 @@ typedef struct _arch_uart_t_
 	int     inbufsz, inf, inl, insz;
 	uint8   *outbuff;
 	int     outbufsz, outf, outl, outsz;
+
+	uint    rx_dropped;	/* software buffer full or receive error */
 }
 arch_uart_t;
 
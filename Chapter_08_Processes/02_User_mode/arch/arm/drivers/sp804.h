@@ -12,6 +12,10 @@
 #define ISP804_COUNT_MAX	((uint32) 0xffffffff) /* (2^32-1)/10^6 s */
 #define ISP804_COUNT_MIN	100 /* 100 us */
 
+/* longest one shot interval: clock source (timer1) must be read before it
+ * wraps around (every ~71 min) - timer0 interrupt guarantees that */
+#define ISP804_ONESHOT_MAX	((uint32) 0x80000000)
+
 /* Calculate time from counter value */
 #define COUNT_TO_TIME(C, T)						\
 do {									\
@@ -19,6 +23,13 @@ do {									\
 	(T)->tv_nsec = ((C) % ISP804_FREQ) * (N1E9 / ISP804_FREQ);	\
 } while (0)
 
+/* Calculate time from 64-bit counter value */
+#define COUNT64_TO_TIME(C, T)						\
+do {									\
+	(T)->tv_sec = (C) / ISP804_FREQ;				\
+	(T)->tv_nsec = (uint32) ((C) % ISP804_FREQ) * (N1E9 / ISP804_FREQ);\
+} while (0)
+
 /* Calculate counter value from time */
 #define TIME_TO_COUNT(T, C)						 \
 do {									 \
@@ -26,7 +37,7 @@ do {									 \
 } while (0)
 
 
-/*! Using timer0 only */
+/*! timer0 - one shot event timer, timer1 - free running clock source */
 
 /*!     Register	base offset */
 #define TIMER_LOAD	0x00000000
@@ -29,7 +29,7 @@ static void uart0_putchar(char c)
 	volatile unsigned int *uart_dr = (unsigned int *) UART0_DR;
 	volatile unsigned int *uart_fr = (unsigned int *) UART0_FR;
 
-	/* Wait for UART to become ready to transmit */
+	/* Wait for space in UART (FIFO, once enabled by PL011 driver) */
 	while ((*uart_fr) &(1 << 5))
 		;
 
@@ -110,7 +110,7 @@ static int uart_status(uint flags, device_t *dev)
 	if (!((*uart_fr) &(1 << 5))) /* Is UART ready to transmit? */
 		rflags |= DEV_OUT_READY;
 
-	return DEV_IN_READY;
+	return rflags;
 }
 
 /*! uart as device_t -----------------------------------------------------*/
@@ -106,6 +106,7 @@ void arch_interrupt_handler(int cpsr)
 {
 	struct ihndlr *ih;
 	int irqn = arch_get_irqn(cpsr & 0x001f);
+	int irq = FALSE;
 
 	extern volatile uint32 *arch_thr_context;
 	extern volatile context_t *arch_active_thr_context;
@@ -117,7 +118,10 @@ void arch_interrupt_handler(int cpsr)
 
 	/* retrieve handler number from interrupt controller for IRQ and FIQ */
 	if (irqn == INT_SRC_IRQ || irqn == INT_SRC_FIQ)
+	{
+		irq = (irqn == INT_SRC_IRQ); /* only IRQs are vectored */
 		irqn = icdev->get_irq();
+	}
 
 	if (irqn > 0 && irqn < INTERRUPTS)
 	{
@@ -130,6 +134,9 @@ void arch_interrupt_handler(int cpsr)
 
 				ih = list_get_next(&ih->list);
 			}
+
+			if (irq)
+				icdev->at_exit(irqn);
 		}
 		else {
 			LOG(ERROR, "Unregistered interrupt: %d!\n(%s)\n",
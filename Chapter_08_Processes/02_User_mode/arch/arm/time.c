@@ -7,16 +7,23 @@
 extern arch_timer_t TIMER;
 static arch_timer_t *timer = &TIMER;
 
-static timespec_t clock;	/* system time starting from 0:00 at power on */
-static timespec_t delay;	/* delay set by kernel, or timer->max_count */
-static timespec_t last_load;/* last time equivalent loaded to counter */
+/*
+ * System time is read from timer's free running clock; event timer is used
+ * in one shot mode only for kernel alarms (tickless). When there is no alarm
+ * (or it is far away) event timer is set to timer->max_interval, so that
+ * clock is read often enough (see get_clock in timer device).
+ */
+static timespec_t clock_set;	/* time set with arch_set_time ... */
+static timespec_t clock_base;	/* ... when clock had this value */
+static timespec_t deadline;	/* when kernel alarm expires */
 
 static timespec_t threshold;/* timer->min_interval / 2 */
 
 static void (*alarm_handler)(); /* kernel function - call when alarm given by
-				    kernel ('delay') expires */
+				    kernel ('deadline') expires */
 
 static void arch_timer_handler(); /* whenever timer expires call this */
+static void arch_timer_load(timespec_t *interval);
 
 void arch_enable_timer_interrupt()	{ timer->enable_interrupt();	}
 void arch_disable_timer_interrupt()	{ timer->disable_interrupt();	}
@@ -29,14 +36,14 @@ void arch_get_min_interval(timespec_t *time)
 /*! Initialize timer 'arch' subsystem: timer device, subsystem data */
 void arch_timer_init()
 {
-	clock.tv_sec = clock.tv_nsec = 0;
 	alarm_handler = NULL;
 
 	timer->init();
 
-	last_load = delay = timer->max_interval;
+	TIME_RESET(&clock_set);
+	timer->get_clock(&clock_base);
 
-	timer->set_interval(&last_load);
+	timer->set_interval(&timer->max_interval);
 	timer->register_interrupt(arch_timer_handler);
 	timer->enable_interrupt();
 
@@ -55,24 +62,18 @@ void arch_timer_init()
  */
 void arch_timer_set(timespec_t *time, void *alarm_func)
 {
-	timespec_t remainder;
-
-	timer->get_interval_remainder(&remainder);
-	time_sub(&last_load, &remainder);
-	time_add(&clock, &last_load);
+	timespec_t delay;
 
 	delay = *time;
 	if (time_cmp(&delay, &timer->min_interval) < 0)
 		delay = timer->min_interval;
 
-	alarm_handler = alarm_func;
+	arch_get_time(&deadline);
+	time_add(&deadline, &delay);
 
-	if (time_cmp(&delay, &timer->max_interval) > 0)
-		last_load = timer->max_interval;
-	else
-		last_load = delay;
+	alarm_handler = alarm_func;
 
-	timer->set_interval(&last_load);
+	arch_timer_load(&delay);
 }
 
 /*!
@@ -81,13 +82,10 @@ void arch_timer_set(timespec_t *time, void *alarm_func)
  */
 void arch_get_time(timespec_t *time)
 {
-	timespec_t remainder;
+	timer->get_clock(time);
 
-	timer->get_interval_remainder(&remainder);
-
-	*time = last_load;
-	time_sub(time, &remainder);
-	time_add(time, &clock);
+	time_sub(time, &clock_base);
+	time_add(time, &clock_set);
 }
 
 /*!
@@ -99,9 +97,10 @@ void arch_set_time(timespec_t *time)
 {
 	void (*k_handler)();
 
-	clock = *time;
-	last_load = timer->max_interval;
-	timer->set_interval(&last_load);
+	timer->get_clock(&clock_base);
+	clock_set = *time;
+
+	timer->set_interval(&timer->max_interval);
 
 	/* let kernel handle time shift problems */
 	if (alarm_handler)
@@ -112,39 +111,50 @@ void arch_set_time(timespec_t *time)
 	}
 }
 
+/*! Start event timer for 'interval', limited to [min, max] interval */
+static void arch_timer_load(timespec_t *interval)
+{
+	if (time_cmp(interval, &timer->min_interval) < 0)
+		timer->set_interval(&timer->min_interval);
+	else if (time_cmp(interval, &timer->max_interval) > 0)
+		timer->set_interval(&timer->max_interval);
+	else
+		timer->set_interval(interval);
+}
+
 /*!
  * Registered 'arch' handler for timer interrupts;
- * update system time and forward interrupt to kernel if its timer is expired
+ * forward interrupt to kernel if its alarm is expired, otherwise restart
+ * event timer for remaining time
  */
 static void arch_timer_handler()
 {
 	void (*k_handler)();
+	timespec_t now, remaining;
 
-	time_add(&clock, &last_load);
+	if (!alarm_handler)
+	{
+		/* no alarm: just keep reading clock */
+		timer->set_interval(&timer->max_interval);
+		return;
+	}
 
-	if (alarm_handler)
+	arch_get_time(&now);
+	time_add(&now, &threshold);
+
+	if (time_cmp(&deadline, &now) <= 0)
 	{
-		time_sub(&delay, &last_load);
-
-		if (time_cmp(&delay, &threshold) <= 0)
-		{
-			/* activate alarm; but first update counter */
-			last_load = timer->max_interval;
-			timer->set_interval(&last_load);
-
-			k_handler = alarm_handler;
-			alarm_handler = NULL; /* reset kernel callback function */
-			k_handler(); /* forward interrupt to kernel */
-		}
-		else {
-			if (time_cmp(&delay, &timer->min_interval) < 0)
-				last_load = timer->min_interval;
-			else if (time_cmp(&delay, &timer->max_interval) < 0)
-				last_load = delay;
-			else
-				last_load = timer->max_interval;
-
-			timer->set_interval(&last_load);
-		}
+		/* activate alarm; but first restart event timer */
+		timer->set_interval(&timer->max_interval);
+
+		k_handler = alarm_handler;
+		alarm_handler = NULL; /* reset kernel callback function */
+		k_handler(); /* forward interrupt to kernel */
+	}
+	else {
+		remaining = deadline;
+		time_sub(&remaining, &now);
+		time_add(&remaining, &threshold);
+		arch_timer_load(&remaining);
 	}
 }
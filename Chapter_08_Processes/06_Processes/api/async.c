@@ -0,0 +1,407 @@
+/*! Asynchronous tasks: stackless coroutines run from an event loop */
+
+#include <api/async.h>
+
+#include <api/stdio.h>
+#include <api/time.h>
+#include <api/pthread.h>
+#include <api/malloc.h>
+#include <api/errno.h>
+
+/*
+ * Event loop runs ready tasks, then blocks in single poll() on descriptors
+ * tasks wait for, with timeout of the nearest timer (timers are kept in a
+ * binary heap). Message queues can't be polled: they are checked with
+ * non blocking mq_receive after every wakeup, and at least every
+ * ASYNC_MQ_INTERVAL ms while some task waits for a message.
+ */
+
+#define ASYNC_MQ_INTERVAL	10	/* ms */
+
+/* what task waits for (async_t.waits) */
+#define W_READY		(1 << 0)
+#define W_TIME		(1 << 1)
+#define W_FD		(1 << 2)
+#define W_MQ		(1 << 3)
+
+static void async_wake(async_t *task, int result);
+static void async_step(async_t *task);
+static int async_timeout(async_loop_t *loop);
+static void async_check_fds(async_loop_t *loop, int timeout);
+static void async_check_mqs(async_loop_t *loop);
+static void async_check_timers(async_loop_t *loop);
+static int heap_add(async_loop_t *loop, async_t *task);
+static void heap_remove(async_loop_t *loop, async_t *task);
+static void heap_swap(async_loop_t *loop, int i, int j);
+
+/*!
+ * Initialize event loop
+ * \param loop Loop descriptor
+ * \param timers_max Maximum number of tasks waiting with timeout
+ * \param fds_max Maximum number of tasks polled at once
+ * \return 0 if successful, -1 otherwise and appropriate error number is set
+ */
+int async_loop_init(async_loop_t *loop, int timers_max, int fds_max)
+{
+	ASSERT_ERRNO_AND_RETURN(loop && timers_max > 0 && fds_max > 0, EINVAL);
+
+	loop->tasks = 0;
+	list_init(&loop->ready);
+	list_init(&loop->fd_wait);
+	list_init(&loop->mq_wait);
+
+	loop->heap = malloc(timers_max * sizeof(async_t *));
+	loop->heap_size = 0;
+	loop->heap_max = timers_max;
+
+	loop->fds = malloc(fds_max * sizeof(struct pollfd));
+	loop->fds_task = malloc(fds_max * sizeof(async_t *));
+	loop->fds_max = fds_max;
+
+	if (!loop->heap || !loop->fds || !loop->fds_task)
+	{
+		async_loop_destroy(loop);
+		set_errno(ENOMEM);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/*! Release memory used by loop (tasks are not finished) */
+void async_loop_destroy(async_loop_t *loop)
+{
+	if (loop->heap)
+		free(loop->heap);
+	if (loop->fds)
+		free(loop->fds);
+	if (loop->fds_task)
+		free(loop->fds_task);
+
+	loop->heap = NULL;
+	loop->fds = NULL;
+	loop->fds_task = NULL;
+}
+
+/*!
+ * Start task (it is run when async_run is called)
+ * \param loop Event loop
+ * \param task Task descriptor (provided by caller, e.g. in its structure)
+ * \param func Task function
+ * \param param Parameter for task (task->param)
+ * \param done Function to call when task is finished (or NULL)
+ */
+void async_start(async_loop_t *loop, async_t *task, int (*func)(async_t *),
+		   void *param, void (*done)(async_t *))
+{
+	task->line = 0;
+	task->func = func;
+	task->param = param;
+	task->done = done;
+	task->result = task->retval = 0;
+	task->loop = loop;
+	task->waits = 0;
+	task->heap_pos = -1;
+
+	loop->tasks++;
+	async_wait_ready(task);
+}
+
+/*!
+ * Run tasks until all are finished
+ * \param loop Event loop
+ * \return 0 when all tasks are finished
+ */
+int async_run(async_loop_t *loop)
+{
+	async_t *task;
+	list_t run;
+	timespec_t t;
+	int timeout;
+
+	while (loop->tasks > 0)
+	{
+		/* tasks that yield now will run in next round */
+		run = loop->ready;
+		list_init(&loop->ready);
+
+		while ((task = list_remove(&run, FIRST, NULL)))
+		{
+			task->waits = 0;
+			async_step(task);
+		}
+
+		if (!loop->tasks)
+			break;
+
+		timeout = async_timeout(loop);
+
+		if (list_get(&loop->fd_wait, FIRST))
+		{
+			async_check_fds(loop, timeout);
+		}
+		else if (timeout > 0)
+		{
+			t.tv_sec = timeout / 1000;
+			t.tv_nsec = (timeout % 1000) * 1000000;
+			clock_nanosleep(CLOCK_MONOTONIC, 0, &t, NULL);
+		}
+		else if (timeout == -1)
+		{
+			break; /* nothing can wake remaining tasks */
+		}
+
+		async_check_mqs(loop);
+		async_check_timers(loop);
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/*! Put task in ready list (ASYNC_YIELD) */
+void async_wait_ready(async_t *task)
+{
+	task->waits = W_READY;
+	task->result = 0;
+	list_append(&task->loop->ready, task, &task->list);
+}
+
+/*! Suspend task for 'ms' milliseconds (ASYNC_SLEEP) */
+void async_wait_time(async_t *task, int ms)
+{
+	timespec_t t;
+
+	clock_gettime(CLOCK_MONOTONIC, &task->wake);
+	t.tv_sec = ms / 1000;
+	t.tv_nsec = (ms % 1000) * 1000000;
+	time_add(&task->wake, &t);
+
+	task->waits = W_TIME;
+	if (heap_add(task->loop, task))
+	{
+		task->waits = 0;
+		async_wake(task, -1); /* too many timers */
+	}
+}
+
+/*! Suspend task until poll event on 'fd' or timeout (ASYNC_AWAIT_FD) */
+void async_wait_fd(async_t *task, int fd, int events, int ms)
+{
+	if (ms >= 0)
+		async_wait_time(task, ms);
+	else
+		task->waits = 0;
+
+	if (task->waits & W_READY)
+		return; /* failed */
+
+	task->fd = fd;
+	task->events = events;
+	task->waits |= W_FD;
+	list_append(&task->loop->fd_wait, task, &task->list);
+}
+
+/*! Suspend task until message is received or timeout (ASYNC_AWAIT_MQ) */
+void async_wait_mq(async_t *task, mqd_t mq, char *buf, size_t len, int ms)
+{
+	if (ms >= 0)
+		async_wait_time(task, ms);
+	else
+		task->waits = 0;
+
+	if (task->waits & W_READY)
+		return;
+
+	task->mq = mq;
+	task->msg = buf;
+	task->msg_len = len;
+	task->waits |= W_MQ;
+	list_append(&task->loop->mq_wait, task, &task->list);
+}
+
+/*! Stop waiting (on all sources) and put task in ready list */
+static void async_wake(async_t *task, int result)
+{
+	async_loop_t *loop = task->loop;
+
+	if (task->waits & W_TIME)
+		heap_remove(loop, task);
+	if (task->waits & W_FD)
+		list_remove(&loop->fd_wait, 0, &task->list);
+	if (task->waits & W_MQ)
+		list_remove(&loop->mq_wait, 0, &task->list);
+
+	task->waits = W_READY;
+	task->result = result;
+	list_append(&loop->ready, task, &task->list);
+}
+
+/*! Continue task; call completion function if it is finished */
+static void async_step(async_t *task)
+{
+	if (task->func(task) == ASYNC_DONE)
+	{
+		task->loop->tasks--;
+		if (task->done)
+			task->done(task);
+	}
+}
+
+/*! Time until first timer expires [ms], -1 if no task waits for time */
+static int async_timeout(async_loop_t *loop)
+{
+	timespec_t now, t;
+	int timeout = -1;
+
+	if (list_get(&loop->ready, FIRST))
+		return 0;
+
+	if (loop->heap_size)
+	{
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		t = loop->heap[0]->wake;
+
+		if (time_cmp(&t, &now) <= 0)
+			return 0;
+
+		time_sub(&t, &now);
+		timeout = t.tv_sec * 1000 + (t.tv_nsec + 999999) / 1000000;
+	}
+
+	if (list_get(&loop->mq_wait, FIRST) &&
+		(timeout == -1 || timeout > ASYNC_MQ_INTERVAL))
+		timeout = ASYNC_MQ_INTERVAL;
+
+	return timeout;
+}
+
+/*! Poll descriptors (first 'fds_max' waiting tasks), wake tasks with events */
+static void async_check_fds(async_loop_t *loop, int timeout)
+{
+	async_t *task;
+	int i, n = 0;
+
+	task = list_get(&loop->fd_wait, FIRST);
+	while (task && n < loop->fds_max)
+	{
+		loop->fds[n].fd = task->fd;
+		loop->fds[n].events = task->events;
+		loop->fds[n].revents = 0;
+		loop->fds_task[n++] = task;
+
+		task = list_get_next(&task->list);
+	}
+
+	if (poll(loop->fds, n, timeout) < 1)
+		return; /* timeout, interrupted or error (timers are checked) */
+
+	for (i = 0; i < n; i++)
+		if (loop->fds[i].revents)
+			async_wake(loop->fds_task[i], loop->fds[i].revents);
+}
+
+/*! Try to receive message for each task waiting on message queue */
+static void async_check_mqs(async_loop_t *loop)
+{
+	async_t *task, *next;
+	ssize_t size;
+
+	task = list_get(&loop->mq_wait, FIRST);
+	while (task)
+	{
+		next = list_get_next(&task->list);
+
+		size = mq_receive(task->mq, task->msg, task->msg_len, NULL);
+		if (size >= 0)
+			async_wake(task, size);
+		else if (get_errno() != EAGAIN)
+			async_wake(task, -1);
+
+		task = next;
+	}
+}
+
+/*! Wake tasks whose timers expired (with result 0) */
+static void async_check_timers(async_loop_t *loop)
+{
+	timespec_t now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	while (loop->heap_size && time_cmp(&loop->heap[0]->wake, &now) <= 0)
+		async_wake(loop->heap[0], 0);
+}
+
+/*! Timer heap (by wake time) ------------------------------------------------ */
+
+static int heap_add(async_loop_t *loop, async_t *task)
+{
+	int i, parent;
+
+	if (loop->heap_size == loop->heap_max)
+		return EXIT_FAILURE;
+
+	i = loop->heap_size++;
+	loop->heap[i] = task;
+	task->heap_pos = i;
+
+	while (i > 0)
+	{
+		parent = (i - 1) / 2;
+		if (time_cmp(&loop->heap[parent]->wake, &task->wake) <= 0)
+			break;
+		heap_swap(loop, i, parent);
+		i = parent;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+static void heap_remove(async_loop_t *loop, async_t *task)
+{
+	int i = task->heap_pos, child, parent;
+
+	task->heap_pos = -1;
+	if (--loop->heap_size == i)
+		return; /* was last */
+
+	loop->heap[i] = loop->heap[loop->heap_size];
+	loop->heap[i]->heap_pos = i;
+
+	/* moved element may need to go up or down */
+	while (i > 0)
+	{
+		parent = (i - 1) / 2;
+		if (time_cmp(&loop->heap[parent]->wake,
+			       &loop->heap[i]->wake) <= 0)
+			break;
+		heap_swap(loop, i, parent);
+		i = parent;
+	}
+
+	for (;;)
+	{
+		child = 2 * i + 1;
+		if (child >= loop->heap_size)
+			break;
+		if (child + 1 < loop->heap_size &&
+			time_cmp(&loop->heap[child + 1]->wake,
+				   &loop->heap[child]->wake) < 0)
+			child++;
+		if (time_cmp(&loop->heap[i]->wake,
+			       &loop->heap[child]->wake) <= 0)
+			break;
+		heap_swap(loop, i, child);
+		i = child;
+	}
+}
+
+static void heap_swap(async_loop_t *loop, int i, int j)
+{
+	async_t *t = loop->heap[i];
+
+	loop->heap[i] = loop->heap[j];
+	loop->heap[j] = t;
+	loop->heap[i]->heap_pos = i;
+	loop->heap[j]->heap_pos = j;
+}
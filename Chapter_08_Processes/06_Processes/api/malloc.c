@@ -0,0 +1,75 @@
+/*! Dynamic memory: process heap size (brk, sbrk), heap extension */
+
+#include <api/malloc.h>
+
+#include <api/syscall.h>
+#include <api/errno.h>
+
+/*!
+ * Set end of process heap (break)
+ * \param addr New break
+ * \return 0 if successful, -1 otherwise (errno is set)
+ */
+int brk(void *addr)
+{
+	ASSERT_ERRNO_AND_RETURN(addr, EINVAL);
+
+	if ((void *) syscall(BRK, addr) != addr)
+		return EXIT_FAILURE;
+
+	return EXIT_SUCCESS;
+}
+
+/*!
+ * Increase (or decrease) process heap
+ * \param increment Number of bytes to add to heap
+ * \return previous break (start of added memory), (void *) -1 on error
+ */
+void *sbrk(ssize_t increment)
+{
+	void *old = (void *) syscall(BRK, NULL);
+
+	if (old == (void *) -1)
+		return old;
+
+	if (increment && brk(old + increment))
+		return (void *) -1;
+
+	return old;
+}
+
+#if MEM_ALLOCATOR_FOR_USER == GMA
+
+/* heap is extended in multiples of HEAP_STEP */
+#define HEAP_STEP	0x1000
+
+/*!
+ * Allocate memory from process pool; when there isn't enough free memory
+ * in pool, increase heap and add new memory to pool
+ * \param size Requested size
+ * \return address of allocated memory, NULL if heap can't grow any more
+ */
+void *mem_alloc(size_t size)
+{
+	void *ptr, *segment;
+	size_t grow;
+
+	ptr = gma_alloc(_uproc_->mpool, size);
+	if (ptr)
+		return ptr;
+
+	/* add some more for chunk headers and allocator's size classes */
+	grow = size + size / 16 + HEAP_STEP;
+	grow = (grow + HEAP_STEP - 1) & ~(HEAP_STEP - 1);
+
+	segment = sbrk(grow);
+	if (segment == (void *) -1)
+		return NULL;
+
+	if (gma_add_segment(_uproc_->mpool, segment, grow))
+		return NULL;
+
+	return gma_alloc(_uproc_->mpool, size);
+}
+
+#endif /* MEM_ALLOCATOR_FOR_USER == GMA */
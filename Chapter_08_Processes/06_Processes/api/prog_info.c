@@ -7,7 +7,7 @@
 #include <api/malloc.h>
 
 /* symbols from user.ld */
-extern char user_code, user_end;
+extern char user_code, user_text, user_data, user_end;
 
 extern int PROG_START_FUNC(char *args[]);
 extern char PROG_HELP[];
@@ -34,6 +34,9 @@ __attribute__((section(".program_header"))) =
 		.heap_size =	HEAP_SIZE,
 		.stack_size =	STACK_SIZE,
 		.thread_stack =	THREAD_STACK_SIZE,
+
+		.text =		&user_text,
+		.data =		&user_data,
 	}
 };
 
@@ -114,6 +114,25 @@ int posix_spawn(pid_t *pid, char *path, void *file_actions,
 	return syscall(POSIX_SPAWN, pid, path, file_actions, attrp, argv, envp);
 }
 
+/*!
+ * Wait for child process to finish
+ * \param pid Child to wait for; any child if pid->ptr is NULL; on return
+ *            finished child (or pid->ptr == NULL if WNOHANG and none is)
+ * \param status Where to store child exit status (if not NULL)
+ * \param options WNOHANG or 0
+ */
+int waitpid(pid_t *pid, int *status, int options)
+{
+	return wait4(pid, status, options, NULL);
+}
+
+/*! As waitpid, but also return resources used by child */
+int wait4(pid_t *pid, int *status, int options, rusage_t *usage)
+{
+	ASSERT_ERRNO_AND_RETURN(pid, EINVAL);
+	return syscall(WAITPID, pid, status, options, usage);
+}
+
 
 /*! Mutex */
 int pthread_mutex_init(pthread_mutex_t *mutex, pthread_mutexattr_t *attr)
@@ -48,7 +48,23 @@ int sigwaitinfo(sigset_t *set, siginfo_t *info)
 {
 	ASSERT_ERRNO_AND_RETURN(set, EINVAL);
 
-	return syscall(SIGWAITINFO, set, info);
+	return syscall(SIGTIMEDWAIT, set, info, NULL);
+}
+
+/*!
+ * Wait for signal, but not longer than 'timeout'
+ * \param set Signals thread is waiting for
+ * \param info Where to save caught signal
+ * \param timeout Maximal time to wait (zero - only check pending signals)
+ * \return signal number if signal is caught,
+ *         -1 otherwise and appropriate error number is set (EAGAIN when
+ *         timeout expired)
+ */
+int sigtimedwait(sigset_t *set, siginfo_t *info, timespec_t *timeout)
+{
+	ASSERT_ERRNO_AND_RETURN(set && timeout, EINVAL);
+
+	return syscall(SIGTIMEDWAIT, set, info, timeout);
 }
 
 /*!
@@ -64,3 +80,19 @@ int pthread_sigmask(int how, sigset_t *set, sigset_t *oset)
 
 	return syscall(PTHREAD_SIGMASK, how, set, oset);
 }
+
+/*!
+ * Switch user threads from signal handler: handler ends and user thread 'to'
+ * continues instead of interrupted code, which is saved in 'from' (both as
+ * with arch_switch_to_uthread); for user threads library
+ * \param from Where to save interrupted user thread
+ * \param to User thread to continue with
+ * \param stack Stack of interrupted thread (switch is made only if it was
+ *              in use)
+ * \param size Stack size
+ * \return doesn't return if successful, -1 otherwise (errno is not changed)
+ */
+int sigswitch(ucontext_t *from, ucontext_t *to, void *stack, size_t size)
+{
+	return syscall(SIGSWITCH, from, to, stack, size, ARCH_UCONTEXT_RESUME);
+}
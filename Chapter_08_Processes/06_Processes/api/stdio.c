@@ -1,6 +1,7 @@
 /*! Printing on stdout, reading from stdin */
 
 #include <api/stdio.h>
+#include <api/signal.h>
 
 #include <api/syscall.h>
 #include <api/prog_info.h>
@@ -58,6 +59,62 @@ int open(char *pathname, int flags, mode_t mode)
 	return i;
 }
 
+/*!
+ * Create descriptor for reading signals queued for calling thread (or change
+ * signal mask of existing one); read returns array of siginfo_t
+ * \param fd Existing signalfd descriptor or -1 to create new one
+ * \param mask Signals to read through descriptor (they should be blocked)
+ * \param flags O_NONBLOCK or 0
+ * \return descriptor, -1 on errors
+ */
+int signalfd(int fd, sigset_t *mask, int flags)
+{
+	descriptor_t desc;
+	int i;
+
+	if (!mask)
+	{
+		set_errno(EINVAL);
+		return EXIT_FAILURE;
+	}
+
+	if (fd != -1)
+	{
+		if (	fd < 0 || fd >= MAX_USER_DESCRIPTORS ||
+			!std_desc[fd].id || !std_desc[fd].ptr)
+		{
+			set_errno(EBADF);
+			return EXIT_FAILURE;
+		}
+
+		if (syscall(SIGNALFD, &std_desc[fd], mask, flags))
+			return EXIT_FAILURE;
+
+		return fd;
+	}
+
+	for (i = 0; i < MAX_USER_DESCRIPTORS; i++)
+		if (std_desc[i].id == 0)
+			break;
+
+	if (i == MAX_USER_DESCRIPTORS)
+	{
+		set_errno(EMFILE);
+		return EXIT_FAILURE;
+	}
+
+	desc.id = 0;
+	desc.ptr = NULL;
+
+	if (syscall(SIGNALFD, &desc, mask, flags))
+		return EXIT_FAILURE;
+
+	std_desc[i].id = desc.id;
+	std_desc[i].ptr = desc.ptr;
+
+	return i;
+}
+
 /*! Close an descriptor */
 int close(int fd)
 {
@@ -144,7 +201,7 @@ void warn(char *format, ...)
  * \param fds set of file descriptors
  * \param nfds number of file descriptors in fds
  * \param timeout minimum time in ms to wait for any event defined by fds
- *       (in current implementation this parameter is ignored)
+ *       (0 - return immediately, -1 - wait until event occurs)
  * \return number of file descriptors with changes in 'revents', -1 on errors
  */
 int poll(struct pollfd fds[], nfds_t nfds, int timeout)
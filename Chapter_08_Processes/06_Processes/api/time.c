@@ -6,6 +6,12 @@
 #include <types/basic.h>
 #include <api/stdio.h>
 #include <api/errno.h>
+#include <api/prog_info.h>
+#include <arch/processor.h>
+
+extern process_t *_uproc_;
+
+static int clock_page_read(timespec_t *time);
 
 /*! Time -------------------------------------------------------------------- */
 
@@ -20,9 +26,58 @@ int clock_gettime(clockid_t clockid, timespec_t *time)
 	ASSERT_ERRNO_AND_RETURN(time && (clockid == CLOCK_REALTIME ||
 				  clockid == CLOCK_MONOTONIC), EINVAL      );
 
+	if (clock_page_read(time) == EXIT_SUCCESS)
+		return EXIT_SUCCESS;
+
 	return syscall(CLOCK_GETTIME, clockid, time);
 }
 
+/*!
+ * Calculate current time from clock page (without system call)
+ * \param time Pointer where to store time
+ * \return 0 if successful, -1 if clock page can't be used (use system call)
+ */
+static int clock_page_read(timespec_t *time)
+{
+	clock_page_t *cpage = _uproc_->clock;
+	timespec_t t, d;
+	uint64 tsc, ns;
+	uint32 seq, mult;
+
+	if (!cpage)
+		return -1;
+
+	do {
+		seq = cpage->seq;
+		memory_barrier();
+
+		if ((seq & 1) || !cpage->valid)
+			return -1; /* kernel will calculate time */
+
+		t = cpage->time;
+		tsc = cpage->tsc;
+		mult = cpage->mult;
+
+		tsc = cpu_tsc() - tsc;
+		memory_barrier();
+	}
+	while (seq != cpage->seq);
+
+	/* clock page is updated on every timer interrupt: interval is short */
+	if (tsc >> 32)
+		return -1;
+	ns = ((uint64) (uint32) tsc * mult) >> CLOCK_PAGE_SHIFT;
+	if (ns >= 1000000000L)
+		return -1;
+
+	d.tv_sec = 0;
+	d.tv_nsec = ns;
+	time_add(&t, &d);
+	*time = t;
+
+	return EXIT_SUCCESS;
+}
+
 /*!
  * Set current time
  * \param clockid Clock to use
@@ -0,0 +1,639 @@
+/*! User threads: many user threads multiplexed over few kernel threads */
+
+#define _UTHREAD_C_
+
+#include <api/uthread.h>
+
+#include <api/pthread.h>
+#include <api/signal.h>
+#include <api/time.h>
+#include <api/malloc.h>
+#include <api/errno.h>
+#include <arch/processor.h>
+
+/*
+ * Each worker (kernel thread) has its own queue of ready threads; when it is
+ * empty, worker takes half of the threads from another worker (or all of
+ * them if that worker is blocked in a system call). Threads are switched
+ * without kernel (arch_switch_to_uthread), always through worker's loop,
+ * so stack of exited thread is returned to pool when it is no longer used.
+ *
+ * Preemption: periodic timer (per worker) signals that time slice expired;
+ * its handler ends with sigswitch, which saves interrupted thread (as
+ * arch_switch_to_uthread would) and continues worker's loop. Threads in
+ * runtime code (holding its locks) are not preempted ('nopreempt'), they
+ * yield on next preemption point (uthread_preempt, uthread_block_end).
+ * Blocking system calls should be enclosed with uthread_block_begin/end
+ * which also stop the timer (its signal would interrupt the call).
+ * Only general registers are switched (not FPU/SSE state).
+ */
+
+#define UTHREAD_SLICE		10000000	/* time slice [ns] */
+#define UTHREAD_SIGNAL		SIGVTALRM
+#define UTHREAD_POOL_MAX	32	/* unused stacks kept for reuse */
+#define UTHREAD_SPIN		100	/* lock retries before backing off */
+
+#define UTHREAD_READY		1
+#define UTHREAD_EXITED		2
+
+typedef struct _uworker_t_
+{
+	pthread_t thread;
+	ucontext_t sched;	/* worker loop context */
+	uthread_t *current;
+
+	volatile int lock;	/* protects 'ready' and 'ready_count' */
+	list_t ready;
+	volatile int ready_count;
+
+	timer_t timer;
+	volatile int resched;	/* time slice expired in runtime code */
+	volatile uint preempted; /* preemption attempts (see uthread_self) */
+	volatile int blocked;	/* current thread is in blocking call */
+}
+uworker_t;
+
+static uworker_t workers[UTHREAD_WORKERS_MAX];
+static int nworkers;
+static volatile int started; /* workers with kernel threads */
+static volatile int slock; /* serializes adding workers (changing 'started') */
+
+static volatile int glock; /* protects data below */
+static int next_id;
+static volatile int uthreads, idle, waking, done;
+static void *pool; /* unused stacks (first word points to next) */
+static int pooled;
+static sem_t idle_sem;
+
+static void lock(volatile int *l);
+static void unlock(volatile int *l);
+static uthread_t *uthread_self();
+static void uthread_switch(uthread_t *self, int state);
+static void *worker_start(void *param);
+static void worker_loop(uworker_t *w);
+static void worker_push(uworker_t *w, uthread_t *thread);
+static uthread_t *worker_take(uworker_t *w);
+static void worker_idle(uworker_t *w);
+static void worker_wake();
+static int worker_add();
+static void worker_timer(uworker_t *w, int on);
+static void worker_tick(siginfo_t *info);
+
+/*!
+ * Initialize user threads
+ * \param n Number of kernel threads (workers) to run user threads with
+ *          (more are added when threads are blocked in system calls)
+ * \return 0 if successful, -1 otherwise and appropriate error number is set
+ */
+int uthreads_init(int n)
+{
+	int i;
+
+	ASSERT_ERRNO_AND_RETURN(n > 0 && n <= UTHREAD_WORKERS_MAX, EINVAL);
+
+	for (i = 0; i < UTHREAD_WORKERS_MAX; i++)
+	{
+		workers[i].current = NULL;
+		workers[i].lock = 0;
+		list_init(&workers[i].ready);
+		workers[i].ready_count = 0;
+		workers[i].resched = workers[i].blocked = FALSE;
+		workers[i].preempted = 0;
+	}
+	nworkers = n;
+	started = 0;
+	slock = 0;
+
+	glock = 0;
+	next_id = 1;
+	uthreads = idle = waking = 0;
+	done = FALSE;
+
+	return sem_init(&idle_sem, 0, 0);
+}
+
+/*!
+ * Run created user threads (calling thread becomes first worker)
+ * \return 0 when all user threads are finished
+ */
+int uthreads_run()
+{
+	int i;
+
+	if (!uthreads)
+		return EXIT_SUCCESS;
+
+	workers[0].thread = pthread_self();
+	started = 1;
+	for (i = 1; i < nworkers; i++)
+		if (worker_add())
+			break;
+
+	worker_start(&workers[0]);
+
+	for (i = 1; i < started; i++)
+		pthread_join(workers[i].thread, NULL);
+
+	started = 0;
+	done = FALSE;
+
+	return EXIT_SUCCESS;
+}
+
+/*!
+ * Create user thread; its stack and descriptor are taken from pool
+ * \param func Starting function
+ * \param param Parameter for starting function
+ * \return thread descriptor, NULL if there is not enough memory
+ */
+uthread_t *create_uthread(void (func)(void *), void *param)
+{
+	uthread_t *thread, *self = uthread_self();
+	void *stack;
+	int id = 0;
+
+	if (self)
+		self->nopreempt++;
+
+	lock(&glock);
+	if (pool)
+	{
+		stack = pool;
+		pool = *((void **) pool);
+		pooled--;
+	}
+	else {
+		stack = malloc(THREAD_STACK_SIZE);
+	}
+	if (stack)
+	{
+		id = next_id++;
+		uthreads++;
+	}
+	unlock(&glock);
+
+	if (!stack)
+	{
+		if (self)
+			self->nopreempt--;
+		return NULL;
+	}
+
+	/* descriptor at the end, stack below it */
+	thread = stack + THREAD_STACK_SIZE - sizeof(uthread_t);
+	thread->id = id;
+	thread->stack = stack;
+	thread->state = UTHREAD_READY;
+	thread->nopreempt = 0;
+
+	arch_create_uthread_context(&thread->context, func, param,
+			uthread_exit, stack, (void *) thread - stack);
+
+	/* new thread goes to creator's worker (others will steal it) */
+	worker_push(self ? self->worker : &workers[id % nworkers], thread);
+
+	if (self)
+	{
+		self->nopreempt--;
+		uthread_preempt();
+	}
+
+	return thread;
+}
+
+/*! End current user thread */
+void uthread_exit()
+{
+	uthread_t *self = uthread_self();
+
+	if (self)
+	{
+		self->nopreempt++;
+		uthread_switch(self, UTHREAD_EXITED);
+	}
+}
+
+/*! Give processor to other ready user thread */
+void uthread_yield()
+{
+	uthread_t *self = uthread_self();
+
+	if (self)
+	{
+		self->nopreempt++;
+		uthread_switch(self, UTHREAD_READY);
+	}
+}
+
+/*!
+ * Preemption point: yield if time slice of current thread expired while it
+ * couldn't be preempted (it was in runtime code)
+ */
+void uthread_preempt()
+{
+	uthread_t *self = uthread_self();
+
+	if (self && !self->nopreempt)
+	{
+		self->nopreempt++;
+		if (self->worker->resched)
+			uthread_switch(self, UTHREAD_READY);
+		else
+			self->nopreempt--;
+	}
+}
+
+/*!
+ * Call before blocking system call: other workers take threads from this
+ * worker's queue (idle worker is woken or a new one started if none is idle);
+ * time slice timer is stopped so its signal doesn't interrupt the call
+ */
+void uthread_block_begin()
+{
+	uthread_t *self = uthread_self();
+	uworker_t *w;
+	int spare;
+
+	if (!self)
+		return;
+
+	self->nopreempt++;
+	w = self->worker;
+	worker_timer(w, FALSE);
+
+	lock(&w->lock);
+	w->blocked = TRUE;
+	unlock(&w->lock);
+
+	if (w->ready_count)
+	{
+		lock(&glock);
+		spare = (idle <= waking);
+		unlock(&glock);
+
+		worker_wake();
+
+		if (spare)
+			worker_add(); /* if it fails, run without it */
+	}
+
+	self->nopreempt--;
+}
+
+/*! Call after blocking system call returns (see uthread_block_begin) */
+void uthread_block_end()
+{
+	uthread_t *self = uthread_self();
+	uworker_t *w;
+
+	if (!self)
+		return;
+
+	self->nopreempt++;
+	w = self->worker;
+
+	lock(&w->lock);
+	w->blocked = FALSE;
+	unlock(&w->lock);
+
+	worker_timer(w, TRUE);
+	self->nopreempt--;
+
+	uthread_preempt();
+}
+
+/*!
+ * Lock shared data; kernel threads aren't preempted by threads with same
+ * priority (SCHED_FIFO) so spinning is only expected when lock holder was
+ * preempted - back off then (sleep) to let it finish
+ */
+static void lock(volatile int *l)
+{
+	timespec_t t;
+	int i = 0;
+
+	while (atomic_swap(l, 1))
+	{
+		if (++i % UTHREAD_SPIN == 0)
+		{
+			t.tv_sec = 0;
+			t.tv_nsec = 1;
+			clock_nanosleep(CLOCK_MONOTONIC, 0, &t, NULL);
+		}
+	}
+}
+
+static void unlock(volatile int *l)
+{
+	memory_barrier();
+	*l = 0;
+}
+
+/*!
+ * Find current user thread: one whose stack is in use; if thread was
+ * preempted while searching it may continue on already checked worker,
+ * so search is repeated when any thread was preempted meanwhile
+ */
+static uthread_t *uthread_self()
+{
+	uthread_t *thread;
+	void *sp = &thread;
+	uint preempted, before;
+	int i;
+
+	for (preempted = 0, i = 0; i < UTHREAD_WORKERS_MAX; i++)
+		preempted += workers[i].preempted;
+
+	do {
+		for (i = 0; i < started; i++)
+		{
+			thread = workers[i].current;
+			if (thread && sp >= thread->stack &&
+			    sp < (void *) thread)
+				return thread;
+		}
+
+		before = preempted;
+		for (preempted = 0, i = 0; i < UTHREAD_WORKERS_MAX; i++)
+			preempted += workers[i].preempted;
+	}
+	while (preempted != before);
+
+	return NULL; /* called from kernel thread, not user thread */
+}
+
+/*!
+ * Save current thread context and return to worker loop
+ * (caller increments 'nopreempt', it is decremented when thread continues)
+ */
+static void uthread_switch(uthread_t *self, int state)
+{
+	self->state = state;
+
+	arch_switch_to_uthread(&self->context, &self->worker->sched);
+	memory_barrier();
+
+	self->nopreempt--;
+}
+
+/*! Worker (kernel thread) starting function */
+static void *worker_start(void *param)
+{
+	uworker_t *w = param;
+	sigaction_t act;
+	sigevent_t evp;
+
+	act.sa_sigaction = worker_tick;
+	act.sa_flags = SA_SIGINFO;
+	sigemptyset(&act.sa_mask);
+	sigaction(UTHREAD_SIGNAL, &act, NULL);
+
+	/* signal is sent to this (creating) thread */
+	evp.sigev_notify = SIGEV_SIGNAL;
+	evp.sigev_signo = UTHREAD_SIGNAL;
+	evp.sigev_value.sival_ptr = w;
+	timer_create(CLOCK_MONOTONIC, &evp, &w->timer);
+	worker_timer(w, TRUE);
+
+	worker_loop(w);
+
+	timer_delete(&w->timer);
+
+	return NULL;
+}
+
+/*! Run ready threads, until all user threads are finished */
+static void worker_loop(uworker_t *w)
+{
+	uthread_t *thread;
+	int i;
+
+	while (!done)
+	{
+		thread = worker_take(w);
+		if (!thread)
+		{
+			worker_idle(w);
+			continue;
+		}
+
+		thread->worker = w;
+		w->current = thread;
+		w->resched = FALSE;
+
+		arch_switch_to_uthread(&w->sched, &thread->context);
+		memory_barrier();
+
+		w->current = NULL;
+
+		if (thread->state == UTHREAD_READY)
+		{
+			worker_push(w, thread);
+			continue;
+		}
+
+		/* thread exited: stack is not used any more */
+		lock(&glock);
+		if (pooled < UTHREAD_POOL_MAX)
+		{
+			*((void **) thread->stack) = pool;
+			pool = thread->stack;
+			pooled++;
+		}
+		else {
+			free(thread->stack);
+		}
+
+		if (--uthreads == 0)
+		{
+			done = TRUE;
+			for (i = 0; i < started; i++)
+				sem_post(&idle_sem);
+		}
+		unlock(&glock);
+	}
+}
+
+/*! Add thread to worker's queue and wake an idle worker */
+static void worker_push(uworker_t *w, uthread_t *thread)
+{
+	lock(&w->lock);
+	list_append(&w->ready, thread, &thread->list);
+	w->ready_count++;
+	unlock(&w->lock);
+
+	worker_wake();
+}
+
+/*! Take first thread from own queue; if empty steal from other workers */
+static uthread_t *worker_take(uworker_t *w)
+{
+	uthread_t *thread, *t;
+	uworker_t *victim;
+	list_t stolen;
+	int i, n, m = 0;
+
+	lock(&w->lock);
+	thread = list_remove(&w->ready, FIRST, NULL);
+	if (thread)
+		w->ready_count--;
+	unlock(&w->lock);
+
+	if (thread)
+		return thread;
+
+	list_init(&stolen);
+
+	for (i = 1; i < started && !thread; i++)
+	{
+		victim = &workers[(w - workers + i) % started];
+		if (!victim->ready_count)
+			continue;
+
+		lock(&victim->lock);
+		n = victim->ready_count;
+		if (!victim->blocked)
+			n = (n + 1) / 2;
+		victim->ready_count -= n;
+
+		/* newest threads (from the end) */
+		if (n > 0)
+			thread = list_remove(&victim->ready, LAST, NULL);
+		while (--n > 0)
+		{
+			t = list_remove(&victim->ready, LAST, NULL);
+			list_prepend(&stolen, t, &t->list);
+			m++;
+		}
+		unlock(&victim->lock);
+	}
+
+	if (m)
+	{
+		lock(&w->lock);
+		while ((t = list_remove(&stolen, FIRST, NULL)))
+			list_append(&w->ready, t, &t->list);
+		w->ready_count += m;
+		unlock(&w->lock);
+	}
+
+	return thread;
+}
+
+/*! Wait until there are ready threads (or all threads are done) */
+static void worker_idle(uworker_t *w)
+{
+	int i, woken = FALSE;
+
+	lock(&glock);
+	idle++;
+	unlock(&glock);
+
+	worker_timer(w, FALSE);
+
+	/* recheck after 'idle' is set: pushes now post semaphore */
+	for (i = 0; i < started && !workers[i].ready_count; i++)
+		;
+	if (i == started && !done)
+		woken = !sem_wait(&idle_sem);
+
+	lock(&glock);
+	idle--;
+	if (woken && waking > 0)
+		waking--;
+	unlock(&glock);
+
+	worker_timer(w, TRUE);
+}
+
+/*! Wake one idle worker, unless enough of them are already being woken */
+static void worker_wake()
+{
+	if (idle <= waking)
+		return;
+
+	lock(&glock);
+	if (idle > waking)
+	{
+		waking++;
+		sem_post(&idle_sem);
+	}
+	unlock(&glock);
+}
+
+/*!
+ * Start kernel thread for worker in first unused slot
+ * \return 0 if successful, -1 if there is no free slot or thread creation
+ *         failed
+ */
+static int worker_add()
+{
+	int i, retval = EXIT_FAILURE;
+
+	/* slot is reserved before thread starts (it must find itself in
+	 * workers) and released if creation fails: it is still the last one
+	 * since 'started' is changed only here, under 'slock' */
+	lock(&slock);
+
+	lock(&glock);
+	i = started;
+	if (i < UTHREAD_WORKERS_MAX)
+		started++;
+	unlock(&glock);
+
+	if (i < UTHREAD_WORKERS_MAX)
+	{
+		retval = pthread_create(&workers[i].thread, NULL, worker_start,
+					 &workers[i]);
+		if (retval)
+		{
+			lock(&glock);
+			started--;
+			unlock(&glock);
+		}
+	}
+
+	unlock(&slock);
+
+	return retval ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/*! Start/stop periodic time slice timer for worker */
+static void worker_timer(uworker_t *w, int on)
+{
+	itimerspec_t t;
+
+	t.it_value.tv_sec = 0;
+	t.it_value.tv_nsec = on ? UTHREAD_SLICE : 0;
+	t.it_interval = t.it_value;
+
+	timer_settime(&w->timer, 0, &t, NULL);
+}
+
+/*!
+ * Timer signal handler: time slice of current thread has expired; switch to
+ * worker loop, unless thread is in runtime code or worker loop is running
+ */
+static void worker_tick(siginfo_t *info)
+{
+	uworker_t *w = info->si_value.sival_ptr;
+	uthread_t *thread = w->current;
+
+	if (!thread)
+		return;
+
+	if (thread->nopreempt)
+	{
+		w->resched = TRUE;
+		return;
+	}
+
+	w->preempted++;
+	memory_barrier();
+
+	thread->state = UTHREAD_READY;
+	sigswitch(&thread->context, &w->sched, thread->stack,
+		   (void *) thread - thread->stack);
+
+	/* interrupted code wasn't using thread's stack (worker loop was) */
+}
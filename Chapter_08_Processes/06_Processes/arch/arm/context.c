@@ -0,0 +1,133 @@
+/*! Processor context */
+
+#define _ARCH_
+#include "context.h"
+
+#include "paging.h"
+#include <kernel/memory.h>
+
+/*! where is thread context saved at interrupt? */
+context_t *arch_thr_context;
+
+/*! thread address space: FCSE PID (process start) and domain access */
+uint32 arch_thr_pid;
+uint32 arch_thr_dacr = ARCH_DACR_KERNEL;
+
+/*! Set up context (normal and interrupt=kernel) */
+void arch_context_init()
+{
+}
+
+/*! context manipulation ---------------------------------------------------- */
+
+/*! Create initial context for thread - it should start with defined function
+  (context is identical to interrupt frame - use same code to start/return) */
+void arch_create_thread_context(context_t *context,
+		void (func)(void *), void *param, void (*thread_exit)(),
+		void *stack, size_t stack_size, void *proc)
+{
+	/* thread context */
+	context->context.pc = (uint32) func;
+	context->context.r[0] = (uint32) param;
+	context->context.lr = (uint32) thread_exit;
+
+	/* stack pointer (as pc) must be in process relative addresses */
+	context->context.sp = (uint32) K2U_GET_ADR(stack + stack_size, proc);
+
+	/* kernel process (idle thread) isn't paged: run it privileged */
+	if (k_process_start_adr(proc))
+		context->context.spsr = INIT_SPSR;
+	else
+		context->context.spsr = INIT_SPSR_K;
+
+	/* rest of context is not relevant for new thread */
+	context->proc = proc;
+}
+
+/*! Cleanups on context when deleting thread (nothing to do) */
+void arch_destroy_thread_context(context_t *context)
+{
+}
+
+/*! user threads: switch from signal handler ------------------------------- */
+
+/*! Get stack pointer of (interrupted) thread (process relative address) */
+void *arch_context_get_stack(context_t *context)
+{
+	return (void *) context->context.sp;
+}
+
+/*!
+ * Save context on its stack, in frame arch_switch_to_uthread can resume
+ * \param context Interrupted thread context
+ * \param from Where to save stack pointer (kernel address)
+ * \param resume Address of arch_uthread_resume in program
+ */
+void arch_context_save_uthread(context_t *context, ucontext_t *from,
+				void *resume)
+{
+	uint32 usp = context->context.sp - ARCH_UCONTEXT_FRAME;
+	uint32 *frame = U2K_GET_ADR((void *) usp, context->proc);
+	int i;
+
+	frame[0] = context->context.r[0];
+	frame[1] = context->context.lr;
+	frame[2] = (uint32) resume;
+
+	for (i = 0; i < 13; i++)
+		frame[3 + i] = context->context.r[i];
+	frame[16] = context->context.lr;
+	frame[17] = context->context.spsr;
+	frame[18] = context->context.pc;
+	if (context->context.spsr & CPSR_THUMB)
+		frame[18] |= 1; /* "ldr pc" switches back to thumb */
+
+	from->sp = (uint32 *) usp;
+}
+
+/*!
+ * Load context saved by arch_switch_to_uthread into thread context
+ * \param context Thread context to replace
+ * \param to Saved user thread (kernel address)
+ * \return 0 if successful, -1 if saved frame isn't within process
+ */
+int arch_context_load_uthread(context_t *context, ucontext_t *to)
+{
+	size_t size = k_process_size(context->proc);
+	uint32 *frame;
+
+	if ((size_t) to->sp > size - 3 * sizeof(uint32))
+		return -1;
+
+	frame = U2K_GET_ADR(to->sp, context->proc);
+
+	context->context.r[0] = frame[0];
+	context->context.lr = frame[1];
+	context->context.pc = frame[2];
+	context->context.sp = (uint32) to->sp + 3 * sizeof(uint32);
+
+	/* resumed code is in arm mode (arch_switch_to_uthread, resume) */
+	context->context.spsr &= ~CPSR_THUMB;
+
+	return 0;
+}
+
+/*! Select thread to return to from interrupt */
+void arch_select_thread(context_t *context)
+{
+	void *start = k_process_start_adr(context->proc);
+
+	arch_thr_context = context;
+
+	if (start)
+	{
+		arch_paging_activate(start, k_process_size(context->proc));
+		arch_thr_pid = (uint32) start;
+		arch_thr_dacr = ARCH_DACR_THREAD;
+	}
+	else {
+		arch_paging_activate(NULL, 0);
+		arch_thr_pid = 0;
+		arch_thr_dacr = ARCH_DACR_KERNEL;
+	}
+}
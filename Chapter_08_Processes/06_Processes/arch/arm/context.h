@@ -0,0 +1,97 @@
+/*! Processor/thread context */
+
+#pragma once
+
+#include "processor.h"
+
+#define	INIT_SPSR	CPSR_MODE_USR /* user mode, interrupts enabled ! */
+#define	INIT_SPSR_K	CPSR_MODE_SYS /* for threads of kernel process */
+
+/* offsets in arch_context_t (used in interrupt.S) */
+#define CNTX_PC		60
+#define CNTX_SPSR	64
+
+#ifndef ASM_FILE
+
+#include <types/basic.h>
+#include <arch/context.h>
+
+/*! context manipulation - for 'kernel threads'  ---------------------------- */
+
+typedef struct _arch_context_t_
+{
+	uint32  r[13];	/* r0-r12 */
+	uint32  sp;	/* user mode sp and lr (banked registers) */
+	uint32  lr;
+	uint32  pc;	/* where to return (1st time: thread function) */
+	uint32  spsr;	/* thread cpsr */
+}
+arch_context_t;
+/* __attribute__((__packed__)) not required since all elem. are 32 bits wide */
+
+struct _context_t_
+{
+	arch_context_t  context;
+
+	void           *proc; /* pointer to thread's process descriptor */
+};
+
+/*! context manipulation - for 'user threads' (in programs) ----------------- */
+
+struct _ucontext_t_
+{
+	uint32  *sp;
+};
+
+/*
+ * Saved user thread (top to bottom of its stack):
+ *	[r0] [lr] [pc] [r4-r11, lr]
+ * New thread starts with 'pc' = func, r0 = param and lr = thread_exit.
+ */
+static inline void arch_create_uthread_context(ucontext_t *context,
+		void (func)(void *), void *param, void (thread_exit)(),
+		void *stack, size_t stack_size)
+{
+	context->sp = stack + stack_size;
+
+	*(--context->sp) = (uint32) func;
+	*(--context->sp) = (uint32) thread_exit;
+	*(--context->sp) = (uint32) param;
+}
+
+static inline void arch_switch_to_uthread(ucontext_t *from, ucontext_t *to)
+{
+	register ucontext_t *f asm ("r4") = from;
+	register ucontext_t *t asm ("r5") = to;
+
+	asm volatile (
+		"	push	{r4-r11, lr}\n"
+		"	adr	r2, 1f\n"
+		"	push	{r2}\n"
+		"	push	{r0, lr}\n"
+		"	str	sp, [%0]\n"
+
+		"	ldr	sp, [%1]\n"
+
+		"	pop	{r0, lr}\n"
+		"	pop	{pc}\n"
+		"1:	pop	{r4-r11, lr}\n"
+
+		: "+r" (f), "+r" (t)
+		:
+		: "r0", "r1", "r2", "r3", "r12", "lr", "memory", "cc"
+	);
+}
+
+/*
+ * Interrupted thread is saved (top to bottom of its stack) as:
+ *	[r0] [lr] [pc = arch_uthread_resume] [r0-r12] [lr] [cpsr] [pc]
+ * so arch_switch_to_uthread "returns" to arch_uthread_resume (in syscall.S)
+ * which restores all registers.
+ */
+#define ARCH_UCONTEXT_FRAME	(19 * sizeof(uint32))
+#define ARCH_UCONTEXT_RESUME	arch_uthread_resume
+
+void arch_uthread_resume();
+
+#endif /* ASM_FILE */
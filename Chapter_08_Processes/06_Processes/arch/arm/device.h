@@ -0,0 +1,7 @@
+/*! all devices headers */
+
+#pragma once
+
+#include <types/io.h>
+
+/* Include headers of devices with device specific flags and constants */
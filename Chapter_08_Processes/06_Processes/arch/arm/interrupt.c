@@ -0,0 +1,199 @@
+/*! Interrupt handling - 'arch' layer (only basic operations) */
+
+#define _ARCH_INTERRUPTS_C_
+#include "interrupt.h"
+
+#include <arch/processor.h>
+#include <kernel/errno.h>
+#include <lib/list.h>
+#include <kernel/memory.h>
+#include <arch/time.h>
+
+/*! Interrupt controller device */
+extern arch_ic_t IC_DEV;
+static arch_ic_t *icdev = &IC_DEV;
+
+/*! interrupt handlers */
+static list_t ihandlers[INTERRUPTS];
+
+/*! kernel function to call on exit from interrupt */
+static void (*exit_handler)(int irq_num, timespec_t *entry) = NULL;
+
+/*!
+ * interrupted: user program or kernel
+ * (for tracking processor generated interrupts)
+ */
+static int new_mode = KERNEL_MODE;
+static int prev_mode = KERNEL_MODE;
+
+struct ihndlr
+{
+	void *device;
+	int (*ihandler)(unsigned int, void *device);
+
+	list_h list;
+};
+
+/* fault status register (c5): status bits of data abort */
+#define FSR_STATUS		0x0f
+#define FSR_TRANSLATION(S)	((S) == 0x5 || (S) == 0x7)
+#define FSR_PERMISSION(S)	((S) == 0xd || (S) == 0xf)
+
+/*! Initialize interrupt susubsystem (in 'arch' layer) */
+void arch_init_interrupts()
+{
+	int i;
+
+	icdev->init();
+
+	for (i = 0; i < INTERRUPTS; i++)
+		list_init(&ihandlers[i]);
+}
+
+/*!
+ * enable and disable interrupts generated outside processor, controller by
+ * interrupt controller (PIC or APIC or ...)
+ */
+void arch_irq_enable(unsigned int irq)
+{
+	icdev->enable_irq(irq);
+}
+void arch_irq_disable(unsigned int irq)
+{
+	icdev->disable_irq(irq);
+}
+
+/*! Register handler function for particular interrupt number */
+void arch_register_interrupt_handler(unsigned int inum, void *handler,
+				       void *device)
+{
+	struct ihndlr *ih;
+
+	if (inum < INTERRUPTS)
+	{
+		ih = kmalloc(sizeof(struct ihndlr));
+		ASSERT(ih);
+
+		ih->device = device;
+		ih->ihandler = handler;
+
+		list_append(&ihandlers[inum], ih, &ih->list);
+	}
+	else {
+		LOG(ERROR, "Interrupt %d can't be used!\n", inum);
+		kprint_flush();
+		halt();
+	}
+}
+
+/*! Register kernel function to be called on exit from each interrupt */
+void arch_register_interrupt_exit_handler(void *handler)
+{
+	exit_handler = handler;
+}
+
+/*! Unregister handler function for particular interrupt number */
+void arch_unregister_interrupt_handler(unsigned int irq_num, void *handler,
+					 void *device)
+{
+	struct ihndlr *ih, *next;
+
+	ASSERT(irq_num >= 0 && irq_num < INTERRUPTS);
+
+	ih = list_get(&ihandlers[irq_num], FIRST);
+
+	while (ih)
+	{
+		next = list_get_next(&ih->list);
+
+		if (ih->ihandler == handler && ih->device == device)
+			list_remove(&ihandlers[irq_num], FIRST, &ih->list);
+
+		ih = next;
+	}
+}
+
+/*!
+ * "Forward" interrupt handling to registered handler
+ * (called from interrupt.S with processor interrupt source, INT_SRC_*)
+ */
+void arch_interrupt_handler(int irqn)
+{
+	struct ihndlr *ih;
+	timespec_t entry;
+	uint32 fsr;
+	int irq = FALSE;
+
+	prev_mode = new_mode;
+	new_mode = KERNEL_MODE;
+
+	if (exit_handler)
+		arch_get_time(&entry);
+
+	/* retrieve handler number from interrupt controller for IRQ and FIQ */
+	if (irqn == INT_SRC_IRQ || irqn == INT_SRC_FIQ)
+	{
+		irq = (irqn == INT_SRC_IRQ); /* only IRQs are vectored */
+		irqn = icdev->get_irq();
+	}
+	else if (irqn == INT_SRC_ABORT)
+	{
+		/* missing page or write to read only page: page fault;
+		 * domain faults (other process, kernel) remain memory faults */
+		asm volatile ("mrc p15, 0, %0, c5, c0, 0" : "=r" (fsr));
+		fsr &= FSR_STATUS;
+		if (FSR_TRANSLATION(fsr) || FSR_PERMISSION(fsr))
+			irqn = INT_PAGE_FAULT;
+	}
+	else if (irqn == INT_SRC_PRE_ABORT)
+	{
+		irqn = INT_MEM_FAULT; /* fault address is not saved */
+	}
+
+	if (irqn > 0 && irqn < INTERRUPTS &&
+		(ih = list_get(&ihandlers[irqn], FIRST)))
+	{
+		/* Call registered handlers */
+		while (ih)
+		{
+			ih->ihandler(irqn, ih->device);
+
+			ih = list_get_next(&ih->list);
+		}
+
+		if (irq)
+			icdev->at_exit(irqn);
+
+		/* kernel: interrupt statistics */
+		if (exit_handler)
+			exit_handler(irqn, &entry);
+	}
+
+	else if (irqn > 0 && irqn < INTERRUPTS)
+	{
+		LOG(ERROR, "Unregistered interrupt: %d - %s!\n",
+		      irqn, icdev->int_descr(irqn));
+		kprint_flush();
+		halt();
+	}
+	else {
+		LOG(ERROR, "Unknown interrupt: %d !\n", irqn);
+		kprint_flush();
+		halt();
+	}
+
+	prev_mode = new_mode;
+	new_mode = USER_MODE;
+}
+
+/*! return current processor operating mode (KERNEL_MODE or USER_MODE) */
+int arch_new_mode()
+{
+	return new_mode;
+}
+
+/*! return previous processor operating mode (KERNEL_MODE or USER_MODE) */
+int arch_prev_mode()
+{
+	return prev_mode;
+}
@@ -0,0 +1,135 @@
+/*! Memory map: kernel, modules (loaded with kernel), heap */
+
+#define _ARCH_
+#include <arch/memory.h>
+
+/*! kernel (interrupt) stack */
+uint8 system_stack [ KERNEL_STACK_SIZE ];
+
+static int arch_modules(uint start, uint end, mseg_t *ms, uint *last);
+static uint arch_find_module(uint start, uint end);
+
+#define ALIGN_UP(ADDR, ALIGN)	(((ADDR) + (ALIGN) - 1) & ~((ALIGN) - 1))
+
+/*!
+ * Create memory map:
+ * - find modules (programs) loaded with kernel
+ * - find place for heap
+ */
+mseg_t *arch_memory_init()
+{
+	extern char kernel_code_addr, kernel_end_addr;
+	uint end = (uint) &kernel_end_addr, mem_end = SYSTEM_MEMORY;
+	uint mod_start, last = 0, mods, nmseg, i;
+	mseg_t *mseg;
+
+	/* assuming memory map:
+	 * - kernel: kernel_code_addr -- kernel_end_addr
+	 * - module(s) placed by qemu (-device loader) on RAMDISK_ADDR (or
+	 *   anywhere above kernel): [module_t header] [rest of module] ...
+	 * - free memory => for segment descriptors and heap
+	 */
+
+	/* there is no boot loader to provide list of modules: search */
+	mod_start = arch_find_module(end, mem_end);
+	mods = arch_modules(mod_start, mem_end, NULL, &last);
+
+	if (last > end)
+		end = last;
+
+	/* segment descriptors: kernel, modules, heap and end marker */
+	nmseg = 1 + mods + 1 + 1;
+	end = ALIGN_UP(end, sizeof(uint));
+	mseg = (mseg_t *) end;
+	end += nmseg * sizeof(mseg_t);
+
+	/* kernel segment - from kernel linker script */
+	i = 0;
+	mseg[i].type = MS_KERNEL;
+	mseg[i].start = &kernel_code_addr;
+	mseg[i].size = (uint) &kernel_end_addr - (uint) &kernel_code_addr;
+	i++;
+
+	i += arch_modules(mod_start, mem_end, &mseg[i], &last);
+
+	/* kernel heap */
+	mseg[i].type = MS_KHEAP;
+	mseg[i].start = (void *) end;
+	mseg[i].size = mem_end - end;
+	i++;
+
+	mseg[i].type = MS_END;
+
+	return mseg;
+}
+
+/*!
+ * Go through modules placed one after another in [start, end)
+ * \param start Address of first module header
+ * \param end End of memory area with modules
+ * \param ms Where to save segment descriptors (if not NULL)
+ * \param last Where to save end address of last module found
+ * \return number of modules found
+ */
+static int arch_modules(uint start, uint end, mseg_t *ms, uint *last)
+{
+	module_t *mod;
+	size_t size;
+	int i = 0;
+
+	while (start && start + sizeof(module_t) <= end)
+	{
+		mod = (module_t *) start;
+
+		if (mod->magic[0] != PMAGIC1 || mod->magic[1] != ~PMAGIC1 ||
+			mod->magic[2] != PMAGIC2 || mod->magic[3] != ~PMAGIC2)
+			break;
+
+		size = (size_t) mod->end - (size_t) mod->start;
+		if (size < sizeof(module_t) || size > end - start)
+			break; /* corrupted header: don't loop or run past end */
+
+		if (ms)
+		{
+			ms[i].type = mod->type;
+			ms[i].start = (void *) mod; /* physical address! */
+			ms[i].size = size;
+		}
+		i++;
+
+		start += size;
+		if (start > *last)
+			*last = start;
+	}
+
+	return i;
+}
+
+/*!
+ * Search memory for module header, first on RAMDISK_ADDR, then (page by
+ * page, modules are page aligned) above kernel
+ * \return address of first module header, 0 if not found
+ */
+static uint arch_find_module(uint start, uint end)
+{
+	module_t *mod;
+	uint addr;
+
+	mod = (module_t *) RAMDISK_ADDR;
+	if (RAMDISK_ADDR >= start && RAMDISK_ADDR + sizeof(module_t) <= end &&
+		mod->magic[0] == PMAGIC1 && mod->magic[1] == ~PMAGIC1 &&
+		mod->magic[2] == PMAGIC2 && mod->magic[3] == ~PMAGIC2)
+		return RAMDISK_ADDR;
+
+	for (addr = ALIGN_UP(start, 4096); addr + sizeof(module_t) <= end;
+	     addr += 4096)
+	{
+		mod = (module_t *) addr;
+
+		if (mod->magic[0] == PMAGIC1 && mod->magic[1] == ~PMAGIC1 &&
+			mod->magic[2] == PMAGIC2 && mod->magic[3] == ~PMAGIC2)
+			return addr;
+	}
+
+	return 0;
+}
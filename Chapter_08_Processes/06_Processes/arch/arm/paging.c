@@ -0,0 +1,307 @@
+/*! Paging (virtual memory) - ARM926EJ-S MMU: sections and coarse tables */
+
+#define _ARCH_
+#include <arch/paging.h>
+
+#include <kernel/errno.h>
+#include <lib/string.h>
+
+/*
+ * Single translation table is used for all processes:
+ * - physical memory [0, mem_end) is identity mapped with sections, for
+ *   kernel only (devices are also mapped that way)
+ * - each process has its own coarse page tables in [PROC_VSTART, PROC_VEND)
+ * - processes are linked from address 0; FCSE PID (set to process start on
+ *   return to thread) relocates addresses below 32 MB into process slot
+ * Isolation: page tables of active process are in ARCH_DOMAIN_ACTIVE, all
+ * other in ARCH_DOMAIN_PROC to which threads have no access (DACR).
+ * Read only and copy on write pages are read only for kernel too (kernel
+ * commits process pages before writing into them).
+ * Caches are virtually indexed: kernel uses frames through identity mapping
+ * and process through its addresses, so both are cleaned on (un)mapping.
+ */
+static uint32 l1_table[4096] __attribute__ ((aligned (0x4000)));
+
+/*! allocator for page tables */
+static void *(*get_frame)() = NULL;
+
+/*! region of active process (its page tables are in ARCH_DOMAIN_ACTIVE) */
+static uint32 active_start = 0, active_end = 0;
+
+#define L1_INDEX(ADR)	(((uint32) (ADR)) >> 20)
+#define L2_INDEX(ADR)	((((uint32) (ADR)) >> 12) & 0xff)
+#define L2_ENTRIES	256
+#define L2_TABLE(E)	((uint32 *) ((E) & ~0x3ff))
+#define SHADOW(PT)	((PT) + 2 * L2_ENTRIES) /* behind both tables */
+#define ENTRY_FRAME(E)	((E) & ~(ARCH_PAGE_SIZE - 1))
+#define SECTION		0x100000
+#define CACHE_LINE	32
+
+#define IS_COARSE(E)	(((E) & ARCH_L1_TYPE) == (ARCH_L1_COARSE & ARCH_L1_TYPE))
+
+#define ARCH_L2_AP_KERNEL	0x550	/* privileged access only */
+
+/*! cache and TLB maintenance (cp15 c7 and c8) */
+static inline void arch_write_buffer_drain()
+{
+	asm volatile ("mcr p15, 0, %0, c7, c10, 4" :: "r" (0) : "memory");
+}
+
+static inline void arch_dcache_clean(void *start, size_t size)
+{
+	uint32 adr;
+
+	for (adr = (uint32) start & ~(CACHE_LINE - 1);
+	     adr < (uint32) start + size; adr += CACHE_LINE)
+		asm volatile ("mcr p15, 0, %0, c7, c10, 1" :: "r" (adr)
+			      : "memory");
+	arch_write_buffer_drain();
+}
+
+/*! clean and invalidate data cache for page, invalidate instruction cache */
+static inline void arch_cache_flush_page(void *vadr)
+{
+	uint32 adr;
+
+	for (adr = (uint32) vadr; adr < (uint32) vadr + ARCH_PAGE_SIZE;
+	     adr += CACHE_LINE)
+		asm volatile ("mcr p15, 0, %0, c7, c14, 1" :: "r" (adr)
+			      : "memory");
+	asm volatile ("mcr p15, 0, %0, c7, c5, 0" :: "r" (0) : "memory");
+	arch_write_buffer_drain();
+}
+
+static inline void arch_tlb_invalidate(void *vadr)
+{
+	asm volatile ("mcr p15, 0, %0, c8, c7, 1" :: "r" (vadr) : "memory");
+}
+
+static inline void arch_tlb_flush()
+{
+	asm volatile ("mcr p15, 0, %0, c8, c7, 0" :: "r" (0) : "memory");
+}
+
+/*! change translation table entry (MMU reads tables from memory) */
+static inline void arch_set_entry(uint32 *entry, uint32 value)
+{
+	*entry = value;
+	arch_dcache_clean(entry, sizeof(uint32));
+}
+
+/*! Return page table for 'vadr', create it if 'create' is set */
+static uint32 *arch_page_table(void *vadr, int create, int domain)
+{
+	uint32 *pt, l1 = L1_INDEX(vadr) & ~1;
+
+	if (IS_COARSE(l1_table[L1_INDEX(vadr)]))
+		return L2_TABLE(l1_table[L1_INDEX(vadr)]);
+
+	if (!create || !(pt = get_frame()))
+		return NULL;
+
+	memset(pt, 0, ARCH_PAGE_SIZE);
+	arch_dcache_clean(pt, 2 * L2_ENTRIES * sizeof(uint32));
+
+	/* one frame for two (neighbouring) megabytes */
+	arch_set_entry(&l1_table[l1], (uint32) pt |
+		       ARCH_L1_DOMAIN(domain) | ARCH_L1_COARSE);
+	arch_set_entry(&l1_table[l1 + 1], (uint32) (pt + L2_ENTRIES) |
+		       ARCH_L1_DOMAIN(domain) | ARCH_L1_COARSE);
+
+	return L2_TABLE(l1_table[L1_INDEX(vadr)]);
+}
+
+/*! Create identity mapping for [0, mem_end) and turn paging on */
+void arch_paging_init(void *(*frame_alloc)(), void *mem_end)
+{
+	extern char arch_vectors;
+	uint32 adr, *pt, ctrl;
+
+	get_frame = frame_alloc;
+
+	memset(l1_table, 0, sizeof(l1_table));
+
+	/* kernel memory (cached) and devices (not cached) */
+	for (adr = 0; adr < (uint32) mem_end; adr += SECTION)
+		l1_table[L1_INDEX(adr)] = adr | ARCH_SECT_AP_KERNEL |
+			ARCH_L2_CB | ARCH_L1_DOMAIN(ARCH_DOMAIN_KERNEL) |
+			ARCH_L1_SECTION;
+
+	for (adr = 0x10000000; adr < 0x10200000; adr += SECTION)
+		l1_table[L1_INDEX(adr)] = adr | ARCH_SECT_AP_KERNEL |
+			ARCH_L1_DOMAIN(ARCH_DOMAIN_KERNEL) | ARCH_L1_SECTION;
+
+	/* exception vectors (page in kernel code) on high address */
+	pt = arch_page_table((void *) ARCH_HIGH_VECTORS, TRUE,
+			     ARCH_DOMAIN_KERNEL);
+	ASSERT(pt);
+	pt[L2_INDEX(ARCH_HIGH_VECTORS)] = ((uint32) &arch_vectors) |
+		ARCH_L2_AP_KERNEL | ARCH_L2_CB | ARCH_L2_SMALL;
+
+	/* caches are not yet enabled; invalidate them and TLB */
+	asm volatile ("mcr p15, 0, %0, c7, c7, 0" :: "r" (0) : "memory");
+	arch_tlb_flush();
+
+	asm volatile (	"mcr p15, 0, %0, c2, c0, 0\n\t"	/* table base */
+			"mcr p15, 0, %1, c3, c0, 0\n\t"	/* domains */
+			"mcr p15, 0, %2, c13, c0, 0\n\t" /* FCSE PID */
+			:: "r" (l1_table), "r" (ARCH_DACR_KERNEL), "r" (0)
+			: "memory");
+
+	asm volatile ("mrc p15, 0, %0, c1, c0, 0" : "=r" (ctrl));
+	ctrl |= ARCH_SCTLR_M | ARCH_SCTLR_C | ARCH_SCTLR_I | ARCH_SCTLR_V |
+		ARCH_SCTLR_R;
+	ctrl &= ~ARCH_SCTLR_S;
+	asm volatile ("mcr p15, 0, %0, c1, c0, 0\n\t"
+		      "nop\n\t"
+		      "nop\n\t"
+		      :: "r" (ctrl) : "memory");
+}
+
+/*! Map page frame to virtual address */
+int arch_page_map(void *vadr, void *frame, int flags)
+{
+	uint32 *pt, old;
+	int domain = ARCH_DOMAIN_PROC;
+
+	if ((uint32) vadr >= active_start && (uint32) vadr < active_end)
+		domain = ARCH_DOMAIN_ACTIVE;
+
+	pt = arch_page_table(vadr, TRUE, domain);
+	if (!pt)
+		return ENOMEM;
+
+	old = pt[L2_INDEX(vadr)];
+	if (old)
+		arch_cache_flush_page(vadr);
+
+	if (flags & ARCH_PAGE_GUARD) /* not present; only marked */
+	{
+		arch_set_entry(&pt[L2_INDEX(vadr)], 0);
+		SHADOW(pt)[L2_INDEX(vadr)] = ARCH_PAGE_GUARD;
+	}
+	else {
+		/* frame was prepared through identity mapping */
+		arch_dcache_clean(frame, ARCH_PAGE_SIZE);
+
+		arch_set_entry(&pt[L2_INDEX(vadr)], ENTRY_FRAME((uint32) frame)
+			| ((flags & ARCH_PAGE_WRITE) && !(flags & ARCH_PAGE_COPY)
+			   ? ARCH_L2_AP_RW : ARCH_L2_AP_RO)
+			| ARCH_L2_CB | ARCH_L2_SMALL);
+		SHADOW(pt)[L2_INDEX(vadr)] = ARCH_PAGE_PRESENT |
+			(flags & (ARCH_PAGE_WRITE | ARCH_PAGE_COPY));
+	}
+
+	if (old)
+		arch_tlb_invalidate(vadr);
+
+	return EXIT_SUCCESS;
+}
+
+/*! Remove mapping for page on 'vadr', return its frame (NULL if unmapped) */
+void *arch_page_unmap(void *vadr)
+{
+	uint32 *pt, entry;
+
+	pt = arch_page_table(vadr, FALSE, 0);
+	if (!pt)
+		return NULL;
+
+	entry = pt[L2_INDEX(vadr)];
+	SHADOW(pt)[L2_INDEX(vadr)] = 0; /* also removes guard mark */
+
+	if (!entry)
+		return NULL;
+
+	/* frame will be used through identity mapping */
+	arch_cache_flush_page(vadr);
+
+	arch_set_entry(&pt[L2_INDEX(vadr)], 0);
+	arch_tlb_invalidate(vadr);
+
+	return (void *) ENTRY_FRAME(entry);
+}
+
+/*! Return frame mapped on 'vadr', NULL if page isn't present */
+void *arch_page_frame(void *vadr)
+{
+	uint32 *pt;
+
+	pt = arch_page_table(vadr, FALSE, 0);
+	if (!pt || !pt[L2_INDEX(vadr)])
+		return NULL;
+
+	return (void *) ENTRY_FRAME(pt[L2_INDEX(vadr)]);
+}
+
+/*! Return flags of page on 'vadr' (PAGE_*), -1 if page isn't mapped */
+int arch_page_flags(void *vadr)
+{
+	uint32 *pt, flags;
+
+	pt = arch_page_table(vadr, FALSE, 0);
+	if (!pt)
+		return -1;
+
+	flags = SHADOW(pt)[L2_INDEX(vadr)];
+
+	if (!(flags & ARCH_PAGE_PRESENT))
+		return (flags & ARCH_PAGE_GUARD) ? ARCH_PAGE_GUARD : -1;
+
+	return flags & (ARCH_PAGE_WRITE | ARCH_PAGE_COPY);
+}
+
+/*! Remove (empty) page table for region containing 'vadr', return it */
+void *arch_page_table_remove(void *vadr)
+{
+	uint32 l1 = L1_INDEX(vadr) & ~1, pt = l1_table[l1];
+
+	if (!IS_COARSE(pt))
+		return NULL;
+
+	arch_set_entry(&l1_table[l1], 0);
+	arch_set_entry(&l1_table[l1 + 1], 0);
+	arch_tlb_flush();
+
+	return (void *) ENTRY_FRAME(pt);
+}
+
+/*! Return address that caused last page fault */
+void *arch_page_fault_adr()
+{
+	void *adr;
+
+	asm volatile ("mrc p15, 0, %0, c6, c0, 0" : "=r" (adr));
+
+	return adr;
+}
+
+/*!
+ * Change domain of active process: page tables of previous one can't be
+ * accessed from user mode anymore (set before returning to thread)
+ */
+void arch_paging_activate(void *start, size_t size)
+{
+	uint32 i, end;
+
+	end = ((uint32) start + size + SECTION - 1) & ~(SECTION - 1);
+	if ((uint32) start == active_start && end == active_end)
+		return;
+
+	for (i = L1_INDEX(active_start); i < L1_INDEX(active_end); i++)
+		if (IS_COARSE(l1_table[i]))
+			arch_set_entry(&l1_table[i],
+				(l1_table[i] & ~ARCH_L1_DOMAIN_MASK) |
+				ARCH_L1_DOMAIN(ARCH_DOMAIN_PROC));
+
+	active_start = (uint32) start;
+	active_end = end;
+
+	for (i = L1_INDEX(active_start); i < L1_INDEX(active_end); i++)
+		if (IS_COARSE(l1_table[i]))
+			arch_set_entry(&l1_table[i],
+				(l1_table[i] & ~ARCH_L1_DOMAIN_MASK) |
+				ARCH_L1_DOMAIN(ARCH_DOMAIN_ACTIVE));
+
+	arch_tlb_flush();
+}
@@ -0,0 +1,59 @@
+/*! Paging (virtual memory) - ARM926EJ-S MMU: sections and coarse tables */
+#pragma once
+
+#define ARCH_PAGE_SIZE		0x1000
+
+/* one page frame holds two coarse page tables (each maps 1 MB) and their
+ * shadow tables with software flags (hardware entries have no free bits) */
+#define ARCH_PAGE_TABLE_SPAN	0x200000
+
+/* processes are placed between 1 GB and 3 GB (physical memory is below);
+ * each in its own 32 MB slot, selected with FCSE PID */
+#define ARCH_PROC_VSTART	0x40000000
+#define ARCH_PROC_VEND		0xC0000000
+#define ARCH_PROC_VSLOT		0x2000000
+
+/* software page flags (in shadow tables) */
+#define ARCH_PAGE_PRESENT	0x001
+#define ARCH_PAGE_WRITE		0x002
+#define ARCH_PAGE_COPY		0x200	/* copy on write */
+#define ARCH_PAGE_GUARD		0x400	/* guard page */
+
+/* first level descriptors */
+#define ARCH_L1_SECTION		0x012	/* section (bit 4 must be 1) */
+#define ARCH_L1_COARSE		0x011	/* coarse page table */
+#define ARCH_L1_TYPE		0x003
+#define ARCH_L1_DOMAIN(D)	((D) << 5)
+#define ARCH_L1_DOMAIN_MASK	(0xf << 5)
+#define ARCH_SECT_AP_KERNEL	(1 << 10) /* privileged access only */
+
+/* second level (small page) descriptors; AP is set for all 4 subpages */
+#define ARCH_L2_SMALL		0x002
+#define ARCH_L2_TYPE		0x003
+#define ARCH_L2_CB		0x00c	/* cacheable, bufferable */
+#define ARCH_L2_AP_RO		0x000	/* read only for both (SCTLR.R) */
+#define ARCH_L2_AP_RW		0xff0	/* read/write for both */
+
+/* domains: kernel, processes (inactive), active process */
+#define ARCH_DOMAIN_KERNEL	0
+#define ARCH_DOMAIN_PROC	1
+#define ARCH_DOMAIN_ACTIVE	2
+
+/* domain access control: 1 - client (check permissions), 0 - no access */
+#define ARCH_DACR_KERNEL	0x15	/* all domains */
+#define ARCH_DACR_THREAD	0x11	/* kernel (privileged) and active one */
+
+/* control register (c1) bits */
+#define ARCH_SCTLR_M		(1 << 0)	/* MMU */
+#define ARCH_SCTLR_C		(1 << 2)	/* data cache */
+#define ARCH_SCTLR_S		(1 << 8)	/* system protection */
+#define ARCH_SCTLR_R		(1 << 9)	/* ROM protection: AP 0 is read only */
+#define ARCH_SCTLR_I		(1 << 12)	/* instruction cache */
+#define ARCH_SCTLR_V		(1 << 13)	/* high vectors: 0xffff0000 */
+
+#define ARCH_HIGH_VECTORS	0xffff0000
+
+#ifndef ASM_FILE
+/*! Change domain of active process: [start, start + size) */
+void arch_paging_activate(void *start, size_t size);
+#endif /* ASM_FILE */
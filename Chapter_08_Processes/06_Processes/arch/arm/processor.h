@@ -0,0 +1,75 @@
+/*! Assembler macros for some processor control instructions */
+
+#pragma once
+
+#define CPSR_IRQ	0xc0	/* I & F bits of CSPR */
+#define CPSR_THUMB	0x20	/* T bit of CPSR */
+
+#define CPSR_MODE_USR	0x10
+#define CPSR_MODE_FIQ	0x11
+#define CPSR_MODE_IRQ	0x12
+#define CPSR_MODE_SVC	0x13
+#define CPSR_MODE_ABT	0x17
+#define CPSR_MODE_UND	0x1b
+#define CPSR_MODE_SYS	0x1f
+
+#define CPSR_MODE_SYS_IF	(CPSR_MODE_SYS|CPSR_IRQ)
+
+#ifndef ASM_FILE
+
+#define arch_disable_interrupts()	\
+asm (	"push {r0}\n\t"			\
+	"mrs r0, cpsr\n\t"		\
+	"orr r0, r0, #0xc0\n\t"		\
+	"msr cpsr, r0\n\t"		\
+	"pop {r0}\n\t")
+
+#define arch_enable_interrupts()	\
+asm (	"push {r0}\n\t"			\
+	"mrs r0, cpsr\n\t"		\
+	"bic r0, r0, #0xc0\n\t"		\
+	"msr cpsr, r0\n\t"		\
+	"pop {r0}\n\t")
+
+#define arch_halt()			\
+do {					\
+	arch_disable_interrupts();	\
+	asm volatile ("b .\n\t");	\
+} while (0)
+
+#define arch_suspend()			asm ("" : : : "memory") /* not supp. */
+#define arch_user_mode_suspend()	asm ("" : : : "memory")
+
+#define arch_raise_interrupt(p)		asm volatile (	"svc %0\n\t" ::	\
+							"i" (p):"memory")
+
+#define arch_memory_barrier()		asm ("" : : : "memory")
+
+#include <arch/types.h>
+
+/*! processor cycle counter: not accessible on ARM926EJ-S, always 0 */
+static inline uint32 arch_cpu_cycles()
+{
+	return 0;
+}
+
+/*! whole cycle counter; not used since arch_cpu_cycles returns 0 */
+static inline uint64 arch_cpu_tsc()
+{
+	return 0;
+}
+
+/*! atomically store 'value' to '*ptr' and return previous value */
+static inline int arch_atomic_swap(volatile int *ptr, int value)
+{
+	int old;
+
+	asm volatile ("swp %0, %2, [%1]"
+		      : "=&r" (old) : "r" (ptr), "r" (value) : "memory");
+
+	return old;
+}
+
+#include <arch/processor.h>
+
+#endif /* ASM_FILE */
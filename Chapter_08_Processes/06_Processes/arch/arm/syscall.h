@@ -0,0 +1,35 @@
+/*! System call (syscall) interface
+ *  used by kernel to retrieve syscall parameters
+ */
+
+#pragma once
+
+#include <arch/context.h>
+#include <kernel/memory.h>
+
+/* syscall is from threads called as: int syscall(id, arg1, arg2, ...);
+ *
+ * first 4 parameters are passed in r0-r3, rest on stack; syscall function
+ * pushes r0-r3 so all are on thread stack (top to bottom):
+ *	[id] [arg1] [arg2] ...
+ *
+ * thread might be in its own address space - convert addresses if required
+ */
+
+/*! Get syscall id from thread stack */
+static inline uint arch_syscall_get_id(context_t *cntx)
+{
+	return U2K_GET_INT((void *) cntx->context.sp, cntx->proc);
+}
+
+/*! Get address of first parameter to syscall (not including id) */
+static inline void *arch_syscall_get_params(context_t *cntx)
+{
+	return U2K_GET_ADR((void *) (cntx->context.sp + 4), cntx->proc);
+}
+
+/*! Save syscall return value for thread; gcc uses r0 register */
+static inline void arch_syscall_set_retval(context_t *cntx, int retval)
+{
+	cntx->context.r[0] = retval;
+}
@@ -0,0 +1,166 @@
+/*! Timer in arch layer; use 'arch_timer_t' device defined in configuration */
+
+#include "time.h"
+
+#include <types/time.h>
+
+extern arch_timer_t TIMER;
+static arch_timer_t *timer = &TIMER;
+
+/*
+ * System time is read from timer's free running clock; event timer is used
+ * in one shot mode only for kernel alarms (tickless). When there is no alarm
+ * (or it is far away) event timer is set to timer->max_interval, so that
+ * clock is read often enough (see get_clock in timer device).
+ */
+static timespec_t clock_set;	/* time set with arch_set_time ... */
+static timespec_t clock_base;	/* ... when clock had this value */
+static timespec_t deadline;	/* when kernel alarm expires */
+
+static timespec_t threshold;/* timer->min_interval / 2 */
+
+static void (*alarm_handler)(); /* kernel function - call when alarm given by
+				    kernel ('deadline') expires */
+
+static void arch_timer_handler(); /* whenever timer expires call this */
+static void arch_timer_load(timespec_t *interval);
+
+void arch_enable_timer_interrupt()	{ timer->enable_interrupt();	}
+void arch_disable_timer_interrupt()	{ timer->disable_interrupt();	}
+
+void arch_get_min_interval(timespec_t *time)
+{
+	*time = timer->min_interval;
+}
+
+/*! Get clock page: NULL, there is no cycle counter to extrapolate time with */
+clock_page_t *arch_clock_page()
+{
+	return NULL;
+}
+
+/*! Initialize timer 'arch' subsystem: timer device, subsystem data */
+void arch_timer_init()
+{
+	alarm_handler = NULL;
+
+	timer->init();
+
+	TIME_RESET(&clock_set);
+	timer->get_clock(&clock_base);
+
+	timer->set_interval(&timer->max_interval);
+	timer->register_interrupt(arch_timer_handler);
+	timer->enable_interrupt();
+
+	threshold.tv_sec = timer->min_interval.tv_sec / 2;
+	threshold.tv_nsec = timer->min_interval.tv_nsec / 2;
+	if (timer->min_interval.tv_sec % 2)
+		threshold.tv_nsec += 1000000000L / 2; /* + half second */
+
+	return;
+}
+
+/*!
+ * Set next timer activation
+ * \param time Time of next activation
+ * \param alarm_func Function to call upon timer expiration
+ */
+void arch_timer_set(timespec_t *time, void *alarm_func)
+{
+	timespec_t delay;
+
+	delay = *time;
+	if (time_cmp(&delay, &timer->min_interval) < 0)
+		delay = timer->min_interval;
+
+	arch_get_time(&deadline);
+	time_add(&deadline, &delay);
+
+	alarm_handler = alarm_func;
+
+	arch_timer_load(&delay);
+}
+
+/*!
+ * Get 'current' system time
+ * \param time Store address for current time
+ */
+void arch_get_time(timespec_t *time)
+{
+	timer->get_clock(time);
+
+	time_sub(time, &clock_base);
+	time_add(time, &clock_set);
+}
+
+/*!
+ * Set 'current' system time
+ * \param time Time to set as current
+ * NOTE: changing clock may have unpredicted behavior on timers!
+ */
+void arch_set_time(timespec_t *time)
+{
+	void (*k_handler)();
+
+	timer->get_clock(&clock_base);
+	clock_set = *time;
+
+	timer->set_interval(&timer->max_interval);
+
+	/* let kernel handle time shift problems */
+	if (alarm_handler)
+	{
+		k_handler = alarm_handler;
+		alarm_handler = NULL; /* reset kernel callback function */
+		k_handler();
+	}
+}
+
+/*! Start event timer for 'interval', limited to [min, max] interval */
+static void arch_timer_load(timespec_t *interval)
+{
+	if (time_cmp(interval, &timer->min_interval) < 0)
+		timer->set_interval(&timer->min_interval);
+	else if (time_cmp(interval, &timer->max_interval) > 0)
+		timer->set_interval(&timer->max_interval);
+	else
+		timer->set_interval(interval);
+}
+
+/*!
+ * Registered 'arch' handler for timer interrupts;
+ * forward interrupt to kernel if its alarm is expired, otherwise restart
+ * event timer for remaining time
+ */
+static void arch_timer_handler()
+{
+	void (*k_handler)();
+	timespec_t now, remaining;
+
+	if (!alarm_handler)
+	{
+		/* no alarm: just keep reading clock */
+		timer->set_interval(&timer->max_interval);
+		return;
+	}
+
+	arch_get_time(&now);
+	time_add(&now, &threshold);
+
+	if (time_cmp(&deadline, &now) <= 0)
+	{
+		/* activate alarm; but first restart event timer */
+		timer->set_interval(&timer->max_interval);
+
+		k_handler = alarm_handler;
+		alarm_handler = NULL; /* reset kernel callback function */
+		k_handler(); /* forward interrupt to kernel */
+	}
+	else {
+		remaining = deadline;
+		time_sub(&remaining, &now);
+		time_add(&remaining, &threshold);
+		arch_timer_load(&remaining);
+	}
+}
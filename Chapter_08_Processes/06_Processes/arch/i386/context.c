@@ -16,9 +16,14 @@ void *arch_interrupt_stack;
 /*! where is thread context saved at interrupt? */
 uint32 arch_thr_context_ss;
 uint32 *arch_thr_context;
+uint32 arch_tsc_supported = 0; /* is TSC supported by processor? */
 #ifdef USE_SSE
 uint32 arch_sse_supported = 0; /* is SSE supported by processor? */
 uint32 arch_sse_mmx_fpu;	/* where to save extended thread context */
+
+/*! released extended context areas, kept for reuse (first word is next) */
+static void *sse_cache = NULL;
+static uint sse_cached = 0;
 #endif
 
 /*! Set up context (normal and interrupt=kernel) */
@@ -72,7 +77,16 @@ void arch_create_thread_context(context_t *context,
 #ifdef USE_SSE
 	if (arch_sse_supported)
 	{
-	context->sse_mmx_fpu_start = kmalloc(SSE_CNTX_SIZE + SSE_CNTX_ALIGN);
+	if (sse_cache)
+	{
+		context->sse_mmx_fpu_start = sse_cache;
+		sse_cache = *((void **) sse_cache);
+		sse_cached--;
+	}
+	else {
+		context->sse_mmx_fpu_start =
+			kmalloc(SSE_CNTX_SIZE + SSE_CNTX_ALIGN);
+	}
 	/* align on 16 byte address */
 	context->sse_mmx_fpu =
 	(((uint32) context->sse_mmx_fpu_start) + SSE_CNTX_ALIGN-1) & 0xfffffff0;
@@ -86,10 +100,85 @@ void arch_destroy_thread_context(context_t *context)
 {
 #ifdef USE_SSE
 	if (arch_sse_supported)
-		kfree(context->sse_mmx_fpu_start);
+	{
+		if (sse_cached < THREAD_CACHE_MAX)
+		{
+			*((void **) context->sse_mmx_fpu_start) = sse_cache;
+			sse_cache = context->sse_mmx_fpu_start;
+			sse_cached++;
+		}
+		else {
+			kfree(context->sse_mmx_fpu_start);
+		}
+	}
 #endif
 }
 
+/*! user threads: switch from signal handler ------------------------------- */
+
+/*! Get stack pointer of (interrupted) thread (process relative address) */
+void *arch_context_get_stack(context_t *context)
+{
+	return context->context.esp;
+}
+
+/*!
+ * Save context as arch_switch_to_uthread would (on its stack)
+ * \param context Interrupted thread context
+ * \param from Where to save stack pointer (kernel address)
+ * \param resume Not used (frame is the same as arch_switch_to_uthread's)
+ */
+void arch_context_save_uthread(context_t *context, ucontext_t *from,
+				void *resume)
+{
+	uint32 *usp = context->context.esp - ARCH_UCONTEXT_FRAME / 4;
+	uint32 *frame = U2K_GET_ADR(usp, context->proc);
+
+	frame[0] = context->context.edi;
+	frame[1] = context->context.esi;
+	frame[2] = context->context.ebp;
+	frame[3] = 0; /* esp, ignored by popal */
+	frame[4] = context->context.ebx;
+	frame[5] = context->context.edx;
+	frame[6] = context->context.ecx;
+	frame[7] = context->context.eax;
+	frame[8] = context->context.eflags;
+	frame[9] = context->context.eip;
+
+	from->esp = usp;
+}
+
+/*!
+ * Load context saved by arch_switch_to_uthread into thread context
+ * \param context Thread context to replace
+ * \param to Saved user thread (kernel address)
+ * \return 0 if successful, -1 if saved frame isn't within process
+ */
+int arch_context_load_uthread(context_t *context, ucontext_t *to)
+{
+	size_t size = k_process_size(context->proc);
+	uint32 *frame;
+
+	if ((size_t) to->esp > size - ARCH_UCONTEXT_FRAME)
+		return -1;
+
+	frame = U2K_GET_ADR(to->esp, context->proc);
+
+	context->context.edi = frame[0];
+	context->context.esi = frame[1];
+	context->context.ebp = frame[2];
+	context->context.ebx = frame[4];
+	context->context.edx = frame[5];
+	context->context.ecx = frame[6];
+	context->context.eax = frame[7];
+	context->context.eflags = (context->context.eflags & ~EFLAGS_USER) |
+				  (frame[8] & EFLAGS_USER);
+	context->context.eip = frame[9];
+	context->context.esp = to->esp + ARCH_UCONTEXT_FRAME / 4;
+
+	return 0;
+}
+
 /*! Select thread to return to from interrupt */
 void arch_select_thread(context_t *context)
 {
@@ -86,6 +86,14 @@ static inline void arch_switch_to_uthread(ucontext_t *from, ucontext_t *to)
 	);
 }
 
+/* frame saved by arch_switch_to_uthread: [edi ... eax] [eflags] [eip];
+ * interrupted thread is saved in the same frame, so it needs no resume code */
+#define ARCH_UCONTEXT_FRAME	(10 * sizeof(uint32))
+#define ARCH_UCONTEXT_RESUME	NULL
+
+/* EFLAGS bits user thread may change (status flags and direction flag) */
+#define EFLAGS_USER		0x0cd5
+
 #ifdef _ARCH_
 
 #ifdef USE_SSE
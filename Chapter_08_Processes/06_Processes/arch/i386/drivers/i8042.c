@@ -138,6 +138,10 @@ static int i8042_interrupt_handler(int irq_num, void *device)
 	if (new_keystrokes && kernel_interrupt_callback_function)
 		kernel_interrupt_callback_function();
 
+	/* notify kernel that new keystrokes are available */
+	if (new_keystrokes && ((device_t *) device)->callback)
+		((device_t *) device)->callback(irq_num, device);
+
 	return new_keystrokes;
 }
 
@@ -55,12 +55,12 @@ static int uart_init(uint flags, void *params, device_t *dev)
 	/* set default parameters */
 	up = dev->params;
 
+	if (up->uart_type)
+		return 0; /* already initialized (e.g. as initial stdout) */
+
 	/* check chip */
 	identify_UART(up);
 
-	if (up->uart_type)
-		return 0; /* already initialized */
-
 	return uart_config(dev, &up->params);
 }
 
@@ -69,6 +69,7 @@ static int uart_config(device_t *dev, uart_t *params)
 {
 	arch_uart_t *up;
 	uint8 setting;
+	int divisor;
 
 	ASSERT_AND_RETURN_ERRNO(dev && params, -EINVAL);
 
@@ -82,6 +83,8 @@ static int uart_config(device_t *dev, uart_t *params)
 	ASSERT_AND_RETURN_ERRNO(params->mode == UART_BYTE ||
 				  params->mode == UART_STREAM,
 				  -EINVAL);
+	ASSERT_AND_RETURN_ERRNO(params->speed > 0 &&
+				  params->speed <= UART_CLOCK, -EINVAL);
 
 	up = dev->params;
 	up->params = *params;
@@ -90,6 +93,7 @@ static int uart_config(device_t *dev, uart_t *params)
 	outb(up->port + IER, 0);
 
 	/* clear FIFO (set FCR) */
+	up->fifo_size = FIFO_SIZE_NONE;
 	if (up->uart_type > UT8250)
 	{
 		setting = FCR_ENABLE | FCR_CLEAR;
@@ -100,22 +104,30 @@ static int uart_config(device_t *dev, uart_t *params)
 			setting |= FCR_STREAM_MODE;
 
 		if (up->uart_type == UT16750)
+		{
 			setting |= FCR_64BYTES;
+			up->fifo_size = FIFO_SIZE_16750;
+		}
+		else if (up->uart_type == UT16550A)
+		{
+			/* (UT16550 has buggy FIFO, send byte by byte) */
+			up->fifo_size = FIFO_SIZE_16550A;
+		}
 
 		outb(up->port + FCR, setting);
 	}
 
 	/* load divisor */
+	divisor = UART_CLOCK / up->params.speed;
 	outb(up->port + LCR, LCR_DLAB_ON); /* set DLAB=1 */
-	outb(up->port + DLL, up->params.speed & 0xff); /* Low Byte */
-	outb(up->port + DLM, up->params.speed >> 8);  /* High Byte */
+	outb(up->port + DLL, divisor & 0xff); /* Low Byte */
+	outb(up->port + DLM, divisor >> 8);  /* High Byte */
 	outb(up->port + LCR, LCR_DLAB_OFF); /* set DLAB=0 */
 
 	/* set LCR */
 	setting = up->params.data_bits - 5;
 	setting |= up->params.parity | up->params.stop_bit | LCR_DLAB_OFF;
-	if (up->uart_type >= UT16550)
-		setting |= LCR_BREAK;
+	outb(up->port + LCR, setting);
 
 	/* set MCR */
 	outb(up->port + MCR, MCR_DEFAULT);
@@ -162,7 +174,7 @@ static int uart_interrupt_handler(int irq_num, void *device)
 		iir = inb(up->port + IIR);
 
 		if (!(iir & IIR_INT_PENDING))
-			return 0; /* no interrupt pending from this device */
+			break; /* no (more) interrupts pending from this device */
 
 		if (iir & IIR_TIMEOUT)
 			brk = TRUE;
@@ -200,18 +212,44 @@ static int uart_interrupt_handler(int irq_num, void *device)
 		}
 	}
 
-	/* TODO: do something with rcv, snd, brk ? */
+	/* notify kernel: data arrived or space in buffer is available */
+	if ((rcv || snd) && dev->callback)
+		dev->callback(irq_num, dev);
+
 	return 0;
 }
 
-/*! If there is data in software buffer send them to UART */
+/*!
+ * If there is data in software buffer send them to UART
+ * - when THR is empty, whole transmit FIFO is empty, so up to 'fifo_size'
+ *   bytes are written without checking LSR for each byte; rest is sent on
+ *   next "THR empty" interrupt
+ * - if that interrupt isn't enabled, keep sending while THR is empty
+ */
 static void uart_write(arch_uart_t *up)
 {
-	while (up->outsz > 0 && inb(up->port + LSR) & LSR_THR_EMPTY)
+	int burst, tx_irq;
+
+	tx_irq = inb(up->port + IER) & IER_THR_EMPTY;
+
+	while (up->outsz > 0 && (inb(up->port + LSR) & LSR_THR_EMPTY))
 	{
-		outb(up->port + THR, up->outbuff[up->outf]);
-		INC_MOD(up->outf, up->outbufsz);
-		up->outsz--;
+		burst = up->fifo_size;
+		if (burst > up->outsz)
+			burst = up->outsz;
+
+		up->outsz -= burst;
+		up->stat.tx_bytes += burst;
+		up->stat.tx_bursts++;
+
+		while (burst-- > 0)
+		{
+			outb(up->port + THR, up->outbuff[up->outf]);
+			INC_MOD(up->outf, up->outbufsz);
+		}
+
+		if (tx_irq)
+			break;
 	}
 }
 
@@ -220,6 +258,7 @@ static int uart_send(void *data, size_t size, uint flags, device_t *dev)
 {
 	arch_uart_t *up;
 	uint8 *d;
+	int sent;
 
 	ASSERT(dev);
 
@@ -231,6 +270,7 @@ static int uart_send(void *data, size_t size, uint flags, device_t *dev)
 
 	up = dev->params;
 	d = data;
+	sent = 0;
 
 	do {
 		/* first, copy to software buffer */
@@ -245,6 +285,7 @@ static int uart_send(void *data, size_t size, uint flags, device_t *dev)
 			INC_MOD(up->outl, up->outbufsz);
 			up->outsz++;
 			size--;
+			sent++;
 		}
 
 		/* second, copy from software buffer to uart */
@@ -252,19 +293,33 @@ static int uart_send(void *data, size_t size, uint flags, device_t *dev)
 	}
 	while (size > 0 && up->outsz < up->outbufsz);
 
-	return size; /* FIXME 0 if all sent, otherwise not send part length */
+	if (size > 0)
+		up->stat.tx_full++;
+
+	return sent; /* number of bytes accepted (copied to buffers) */
 }
 
 /*! Read data from UART to software buffer */
 static void uart_read(arch_uart_t *up)
 {
+	uint8 lsr;
+
 	/* While UART is not empty and software buffer is not full */
-	while ((inb(up->port + LSR) & LSR_DATA_READY)
-		&& up->insz < up->inbufsz)
+	while ((lsr = inb(up->port + LSR)) & LSR_DATA_READY)
 	{
+		if (lsr & LSR_OVERRUN)
+			up->stat.rx_overruns++;
+
+		if (up->insz == up->inbufsz)
+		{
+			up->stat.rx_full++;
+			break;
+		}
+
 		up->inbuff[up->inl] = inb(up->port + RBR);
 		INC_MOD(up->inl, up->inbufsz);
 		up->insz++;
+		up->stat.rx_bytes++;
 	}
 }
 
@@ -332,9 +387,26 @@ static int uart_status(uint flags, device_t *dev)
 	return rflags;
 }
 
+/*! Print statistics (sysinfo devices) */
+static int uart_info(device_t *dev)
+{
+	arch_uart_t *up;
+
+	ASSERT(dev);
+
+	up = dev->params;
+
+	kprintf("\trx_bytes=%d\ttx_bytes=%d\ttx_bursts=%d\n",
+		 up->stat.rx_bytes, up->stat.tx_bytes, up->stat.tx_bursts);
+	kprintf("\trx_overruns=%d\trx_full=%d\ttx_full=%d\n",
+		 up->stat.rx_overruns, up->stat.rx_full, up->stat.tx_full);
+
+	return 0;
+}
+
 /*! uart0 device & parameters */
-static uint8 com1_inbuf[BUFFER_SIZE];
-static uint8 com1_outbuf[BUFFER_SIZE];
+static uint8 com1_inbuf[UART_INBUF_SIZE];
+static uint8 com1_outbuf[UART_OUTBUF_SIZE];
 
 /*! COM1 device & parameters */
 static arch_uart_t com1_params = (arch_uart_t)
@@ -342,10 +414,11 @@ static arch_uart_t com1_params = (arch_uart_t)
 	.uart_type = UNDEFINED,
 	.params = UART_DEFAULT_SETTING,
 	.port = COM1_BASE,
+	.fifo_size = FIFO_SIZE_NONE,
 	.inbuff = com1_inbuf,
-	.inbufsz=BUFFER_SIZE, .inf = 0, .inl = 0, .insz = 0,
+	.inbufsz=UART_INBUF_SIZE, .inf = 0, .inl = 0, .insz = 0,
 	.outbuff = com1_outbuf,
-	.outbufsz=BUFFER_SIZE, .outf = 0, .outl = 0, .outsz = 0
+	.outbufsz=UART_OUTBUF_SIZE, .outf = 0, .outl = 0, .outsz = 0
 };
 
 /*! uart as device_t */
@@ -361,6 +434,7 @@ device_t uart_com1 = (device_t)
 	.send =		uart_send,
 	.recv =		uart_recv,
 	.status =	uart_status,
+	.info =		uart_info,
 
 	.flags = 	DEV_TYPE_SHARED | DEV_TYPE_CONSOLE,
 	.params = 	&com1_params
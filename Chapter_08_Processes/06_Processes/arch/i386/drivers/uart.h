@@ -22,6 +22,19 @@ typedef struct _uart_t_
 }
 uart_t;
 
+/* statistics for serial port (counters since initialization) */
+typedef struct _uart_stat_t_
+{
+	uint32 rx_bytes;	/* bytes moved from UART to software buffer	*/
+	uint32 tx_bytes;	/* bytes moved from software buffer to UART	*/
+	uint32 tx_bursts;	/* number of FIFO fills (bursts) on transmit	*/
+	uint32 rx_overruns;	/* UART reported overrun (data lost in chip)	*/
+	uint32 rx_full;		/* input software buffer was full		*/
+	uint32 tx_full;		/* output software buffer was full (send
+				   could not accept all data)			*/
+}
+uart_stat_t;
+
 #define PARITY_NONE	(0 << 3)
 #define PARITY_ODD	(1 << 3)
 #define PARITY_EVEN	(3 << 3)
@@ -56,6 +69,7 @@ uart_t;
 
 #define IER_DEFAULT	7
 #define IER_DISABLE	0
+#define IER_THR_EMPTY	(1 << 1)
 
 #define FCR_ENABLE	0x01
 #define FCR_CLEAR	0x06
@@ -77,12 +91,27 @@ uart_t;
 #define IIR_TIMEOUT	(6 << 1)
 
 #define LSR_DATA_READY	(1 << 0)
+#define LSR_OVERRUN	(1 << 1)
 #define LSR_BREAK	(1 << 4)
 #define LSR_THR_EMPTY	(1 << 5)
 #define LSR_DHR_EMPTY	(1 << 6)
 
 
-#define BUFFER_SIZE	256	/* software buffer size */
+/* software buffer sizes (set in config.ini) */
+#ifndef UART_INBUF_SIZE
+#define UART_INBUF_SIZE		256
+#endif
+#ifndef UART_OUTBUF_SIZE
+#define UART_OUTBUF_SIZE	1024
+#endif
+
+/* transmit FIFO depth (bytes that can be written when THR is empty) */
+#define FIFO_SIZE_NONE		1
+#define FIFO_SIZE_16550A	16
+#define FIFO_SIZE_16750		64
+
+/* UART input clock / 16 - divisor for requested speed is UART_CLOCK/speed */
+#define UART_CLOCK		115200
 
 typedef struct _arch_uart_t_
 {
@@ -92,10 +121,14 @@ typedef struct _arch_uart_t_
 
 	int     port;
 
+	int     fifo_size;	/* bytes to send on single THR empty */
+
 	uint8   *inbuff;
 	int     inbufsz, inf, inl, insz;
 	uint8   *outbuff;
 	int     outbufsz, outf, outl, outsz;
+
+	uart_stat_t stat;
 }
 arch_uart_t;
 
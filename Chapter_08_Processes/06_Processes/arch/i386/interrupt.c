@@ -7,6 +7,7 @@
 #include <kernel/errno.h>
 #include <lib/list.h>
 #include <kernel/memory.h>
+#include <arch/time.h>
 
 /*! Interrupt controller device */
 extern arch_ic_t IC_DEV;
@@ -15,6 +16,9 @@ static arch_ic_t *icdev = &IC_DEV;
 /*! interrupt handlers */
 static list_t ihandlers[INTERRUPTS];
 
+/*! kernel function to call on exit from interrupt */
+static void (*exit_handler)(int irq_num, timespec_t *entry) = NULL;
+
 /*!
  * interrupted: user program or kernel
  * (for tracking processor generated interrupts)
@@ -72,10 +76,17 @@ void arch_register_interrupt_handler(unsigned int inum, void *handler,
 	}
 	else {
 		LOG(ERROR, "Interrupt %d can't be used!\n", inum);
+		kprint_flush();
 		halt();
 	}
 }
 
+/*! Register kernel function to be called on exit from each interrupt */
+void arch_register_interrupt_exit_handler(void *handler)
+{
+	exit_handler = handler;
+}
+
 /*! Unregister handler function for particular interrupt number */
 void arch_unregister_interrupt_handler(unsigned int irq_num, void *handler,
 					 void *device)
@@ -104,10 +115,14 @@ void arch_unregister_interrupt_handler(unsigned int irq_num, void *handler,
 void arch_interrupt_handler(int irq_num)
 {
 	struct ihndlr *ih;
+	timespec_t entry;
 
 	prev_mode = new_mode;
 	new_mode = KERNEL_MODE;
 
+	if (exit_handler)
+		arch_get_time(&entry);
+
 	if (irq_num < INTERRUPTS && (ih = list_get(&ihandlers[irq_num], FIRST)))
 	{
 		/* Call registered handlers */
@@ -120,16 +135,22 @@ void arch_interrupt_handler(int irq_num)
 
 		if (icdev->at_exit)
 			icdev->at_exit(irq_num);
+
+		/* kernel: interrupt statistics */
+		if (exit_handler)
+			exit_handler(irq_num, &entry);
 	}
 
 	else if (irq_num < INTERRUPTS)
 	{
 		LOG(ERROR, "Unregistered interrupt: %d - %s!\n",
 		      irq_num, icdev->int_descr(irq_num));
+		kprint_flush();
 		halt();
 	}
 	else {
 		LOG(ERROR, "Unregistered interrupt: %d !\n", irq_num);
+		kprint_flush();
 		halt();
 	}
 
@@ -5,9 +5,11 @@
 /* Constants */
 #define INT_STF			12	/* Stack Fault */
 #define INT_GPF			13	/* General Protection Fault */
+#define INT_PF			14	/* Page Fault */
 
 #define INT_MEM_FAULT		INT_STF
 #define INT_UNDEF_FAULT		INT_GPF
+#define INT_PAGE_FAULT		INT_PF
 
 #ifndef ASM_FILE
 
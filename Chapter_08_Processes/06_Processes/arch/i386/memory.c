@@ -2,70 +2,181 @@
 
 #define _ARCH_
 #include <arch/memory.h>
+#include <arch/multiboot.h>
 
 /*! kernel (interrupt) stack */
 uint8 system_stack [ KERNEL_STACK_SIZE ];
 
-/* adjust if more than 16 programs are used */
-#define MAX_MEMORY_SEGMENTS	16
-
-/* reserve space for segment descriptors */
-static mseg_t mseg[MAX_MEMORY_SEGMENTS];
-
-/* multiboot information - currently not used */
+/* multiboot information (saved in startup.S) */
 unsigned long arch_mb_magic, arch_mb_info;
 
+static int arch_modules(uint start, uint end, mseg_t *ms, uint *last);
+static uint arch_find_module(uint start, uint end);
+
+#define ALIGN_UP(ADDR, ALIGN)	(((ADDR) + (ALIGN) - 1) & ~((ALIGN) - 1))
 
 /*!
  * Create memory map:
+ * - find modules (programs) loaded with kernel
  * - find place for heap
  */
 mseg_t *arch_memory_init()
 {
 	extern char kernel_code_addr, kernel_end_addr;
-	uint addr, end = (uint) &kernel_end_addr;
-	module_t *mod;
-	int i = 0;
+	uint end = (uint) &kernel_end_addr, mem_end = SYSTEM_MEMORY;
+	uint mod_start = 0, last = 0; /* when not using multiboot info */
+	multiboot_info_t *mbi = NULL;
+	multiboot_module_t *mbmod = NULL;
+	multiboot_mmap_t *mmap;
+	uint mods = 0, nmseg, i, j;
+	mseg_t *mseg;
 
 	/* assuming memory map:
 	 * - kernel: kernel_code_addr -- kernel_end_addr
 	 * - (debug sections and loader stuff)
-	 * - module: [module_t header] [rest of module]
-	 * - (more modules)
-	 * - free memory => for heap
+	 * - module(s): [module_t header] [rest of module] (more modules)
+	 * - free memory => for segment descriptors and heap
 	 */
 
+	if (arch_mb_magic == MULTIBOOT_BOOTLOADER_MAGIC)
+		mbi = (multiboot_info_t *) arch_mb_info;
+
+	/* memory size: from memory map (region where kernel is loaded) */
+	if (mbi && (mbi->flags & MULTIBOOT_INFO_MEM_MAP))
+	{
+		mmap = (multiboot_mmap_t *) mbi->mmap_addr;
+		while ((uint) mmap < mbi->mmap_addr + mbi->mmap_length)
+		{
+			if (mmap->type == MULTIBOOT_MEMORY_AVAILABLE &&
+				!mmap->base_addr_high &&
+				mmap->base_addr_low <= LOAD_ADDR &&
+				mmap->base_addr_low + mmap->length_low > LOAD_ADDR)
+			{
+				mem_end = mmap->base_addr_low +
+					  mmap->length_low;
+			}
+			mmap = (void *) mmap + mmap->size + sizeof(mmap->size);
+		}
+	}
+	else if (mbi && (mbi->flags & MULTIBOOT_INFO_MEMORY))
+	{
+		mem_end = (mbi->mem_upper + 1024) * 1024;
+	}
+
+	/* modules: from multiboot module list, or search for first one */
+	if (mbi && (mbi->flags & MULTIBOOT_INFO_MODS))
+	{
+		mbmod = (multiboot_module_t *) mbi->mods_addr;
+		for (i = 0; i < mbi->mods_count; i++)
+		{
+			mods += arch_modules(mbmod[i].mod_start,
+					     mbmod[i].mod_end, NULL, &last);
+			if (mbmod[i].mod_end > last)
+				last = mbmod[i].mod_end;
+		}
+	}
+	else {
+		mod_start = arch_find_module(end, mem_end);
+		mods = arch_modules(mod_start, mem_end, NULL, &last);
+	}
+
+	if (last > end)
+		end = last;
+
+	/* segment descriptors: kernel, modules, heap and end marker */
+	nmseg = 1 + mods + 1 + 1;
+	end = ALIGN_UP(end, sizeof(uint));
+	mseg = (mseg_t *) end;
+	end += nmseg * sizeof(mseg_t);
+
 	/* kernel segment - from kernel linker script */
+	i = 0;
 	mseg[i].type = MS_KERNEL;
 	mseg[i].start = &kernel_code_addr;
 	mseg[i].size = (uint) &kernel_end_addr - (uint) &kernel_code_addr;
 	i++;
 
-	for (addr = end; addr < SYSTEM_MEMORY; addr+=4)
+	if (mbmod)
 	{
-		mod = (module_t *) addr;
-
-		if (mod->magic[0] == PMAGIC1 && mod->magic[1] == ~PMAGIC1 &&
-			mod->magic[2] == PMAGIC2 && mod->magic[3] == ~PMAGIC2)
-		{
-			/* found module at addr */
-			mseg[i].type = mod->type;
-			mseg[i].start = (void *) mod; /* physical address! */
-			mseg[i].size = (size_t) mod->end - (size_t) mod->start;
-			addr += mseg[i].size-4;
-			end = addr+4;
-			i++;
-			continue;
-		}
+		for (j = 0; j < mbi->mods_count; j++)
+			i += arch_modules(mbmod[j].mod_start, mbmod[j].mod_end,
+					   &mseg[i], &last);
+	}
+	else {
+		i += arch_modules(mod_start, mem_end, &mseg[i], &last);
 	}
 
 	/* kernel heap */
 	mseg[i].type = MS_KHEAP;
 	mseg[i].start = (void *) end;
-	mseg[i].size = SYSTEM_MEMORY - (uint) mseg[i].start;
+	mseg[i].size = mem_end - end;
 	i++;
 
 	mseg[i].type = MS_END;
 
 	return mseg;
 }
+
+/*!
+ * Go through modules placed one after another in [start, end)
+ * \param start Address of first module header
+ * \param end End of memory area with modules
+ * \param ms Where to save segment descriptors (if not NULL)
+ * \param last Where to save end address of last module found
+ * \return number of modules found
+ */
+static int arch_modules(uint start, uint end, mseg_t *ms, uint *last)
+{
+	module_t *mod;
+	size_t size;
+	int i = 0;
+
+	while (start && start + sizeof(module_t) <= end)
+	{
+		mod = (module_t *) start;
+
+		if (mod->magic[0] != PMAGIC1 || mod->magic[1] != ~PMAGIC1 ||
+			mod->magic[2] != PMAGIC2 || mod->magic[3] != ~PMAGIC2)
+			break;
+
+		size = (size_t) mod->end - (size_t) mod->start;
+		if (size < sizeof(module_t) || size > end - start)
+			break; /* corrupted header: don't loop or run past end */
+
+		if (ms)
+		{
+			ms[i].type = mod->type;
+			ms[i].start = (void *) mod; /* physical address! */
+			ms[i].size = size;
+		}
+		i++;
+
+		start += size;
+		if (start > *last)
+			*last = start;
+	}
+
+	return i;
+}
+
+/*!
+ * Search memory for module header (when boot loader didn't provide list of
+ * modules)
+ * \return address of first module header, 0 if not found
+ */
+static uint arch_find_module(uint start, uint end)
+{
+	module_t *mod;
+	uint addr;
+
+	for (addr = start; addr + sizeof(module_t) <= end; addr += 4)
+	{
+		mod = (module_t *) addr;
+
+		if (mod->magic[0] == PMAGIC1 && mod->magic[1] == ~PMAGIC1 &&
+			mod->magic[2] == PMAGIC2 && mod->magic[3] == ~PMAGIC2)
+			return addr;
+	}
+
+	return 0;
+}
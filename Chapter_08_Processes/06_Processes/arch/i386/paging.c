@@ -0,0 +1,183 @@
+/*! Paging (virtual memory) - i386 page directory and page tables */
+
+#define _ARCH_
+#include <arch/paging.h>
+
+#include <kernel/errno.h>
+#include <lib/string.h>
+
+/*
+ * Single page directory is used for all processes:
+ * - physical memory [0, mem_end) is identity mapped (kernel and its heap)
+ * - each process has its own page table(s) in [PROC_VSTART, PROC_VEND),
+ *   so page directory (CR3) is never changed on thread switch
+ * All pages are marked as 'user' pages - isolation between processes (and
+ * kernel) is still provided with segmentation (segment base and limit).
+ * Write protection is enforced for kernel too (CR0.WP): kernel commits
+ * process pages before writing into them (copy on write is not done in
+ * kernel mode), so missed commit faults instead of changing shared frame.
+ */
+static uint32 *page_dir = NULL;
+
+/*! allocator for page tables */
+static void *(*get_frame)() = NULL;
+
+#define PDE_INDEX(ADR)	(((uint32) (ADR)) >> 22)
+#define PTE_INDEX(ADR)	((((uint32) (ADR)) >> 12) & 0x3ff)
+#define ENTRY_FRAME(E)	((E) & ~(ARCH_PAGE_SIZE - 1))
+
+#define PDE_FLAGS	(ARCH_PAGE_PRESENT | ARCH_PAGE_WRITE | ARCH_PAGE_USER)
+
+static inline void arch_tlb_invalidate(void *vadr)
+{
+	asm volatile ("invlpg (%0)\n\t" :: "r" (vadr) : "memory");
+}
+
+/*! Create identity mapping for [0, mem_end) and turn paging on */
+void arch_paging_init(void *(*frame_alloc)(), void *mem_end)
+{
+	uint32 adr, *pt = NULL;
+
+	get_frame = frame_alloc;
+
+	page_dir = get_frame();
+	ASSERT(page_dir);
+	memset(page_dir, 0, ARCH_PAGE_SIZE);
+
+	for (adr = 0; adr < (uint32) mem_end; adr += ARCH_PAGE_SIZE)
+	{
+		if (!pt || !PTE_INDEX(adr))
+		{
+			pt = get_frame();
+			ASSERT(pt);
+			memset(pt, 0, ARCH_PAGE_SIZE);
+			page_dir[PDE_INDEX(adr)] = (uint32) pt | PDE_FLAGS;
+		}
+		pt[PTE_INDEX(adr)] = adr | PDE_FLAGS;
+	}
+
+	asm volatile (	"movl %0, %%cr3\n\t"
+			"movl %%cr0, %%eax\n\t"
+			"orl %1, %%eax\n\t"
+			"movl %%eax, %%cr0\n\t"
+			"jmp 1f\n\t"
+			"1:\n\t"
+			:: "r" (page_dir), "i" (ARCH_CR0_PG | ARCH_CR0_WP)
+			: "eax", "memory");
+}
+
+/*! Map page frame to virtual address */
+int arch_page_map(void *vadr, void *frame, int flags)
+{
+	uint32 *pde, *pt, old;
+
+	pde = &page_dir[PDE_INDEX(vadr)];
+
+	if (!(*pde & ARCH_PAGE_PRESENT))
+	{
+		pt = get_frame();
+		if (!pt)
+			return ENOMEM;
+		memset(pt, 0, ARCH_PAGE_SIZE);
+		*pde = (uint32) pt | PDE_FLAGS;
+	}
+	pt = (uint32 *) ENTRY_FRAME(*pde);
+
+	old = pt[PTE_INDEX(vadr)];
+	if (flags & ARCH_PAGE_COPY)
+		flags &= ~ARCH_PAGE_WRITE; /* first write will cause fault */
+
+	if (flags & ARCH_PAGE_GUARD) /* not present; only marked */
+		pt[PTE_INDEX(vadr)] = ARCH_PAGE_GUARD;
+	else
+		pt[PTE_INDEX(vadr)] = ENTRY_FRAME((uint32) frame) |
+			ARCH_PAGE_PRESENT | ARCH_PAGE_USER |
+			(flags & (ARCH_PAGE_WRITE | ARCH_PAGE_COPY));
+
+	if (old & ARCH_PAGE_PRESENT)
+		arch_tlb_invalidate(vadr);
+
+	return EXIT_SUCCESS;
+}
+
+/*! Remove mapping for page on 'vadr', return its frame (NULL if unmapped) */
+void *arch_page_unmap(void *vadr)
+{
+	uint32 *pt, entry;
+
+	if (!(page_dir[PDE_INDEX(vadr)] & ARCH_PAGE_PRESENT))
+		return NULL;
+
+	pt = (uint32 *) ENTRY_FRAME(page_dir[PDE_INDEX(vadr)]);
+	entry = pt[PTE_INDEX(vadr)];
+	pt[PTE_INDEX(vadr)] = 0; /* also removes guard mark */
+
+	if (!(entry & ARCH_PAGE_PRESENT))
+		return NULL;
+
+	arch_tlb_invalidate(vadr);
+
+	return (void *) ENTRY_FRAME(entry);
+}
+
+/*! Return frame mapped on 'vadr', NULL if page isn't present */
+void *arch_page_frame(void *vadr)
+{
+	uint32 *pt, entry;
+
+	if (!(page_dir[PDE_INDEX(vadr)] & ARCH_PAGE_PRESENT))
+		return NULL;
+
+	pt = (uint32 *) ENTRY_FRAME(page_dir[PDE_INDEX(vadr)]);
+	entry = pt[PTE_INDEX(vadr)];
+
+	if (!(entry & ARCH_PAGE_PRESENT))
+		return NULL;
+
+	return (void *) ENTRY_FRAME(entry);
+}
+
+/*! Return flags of page on 'vadr' (PAGE_*), -1 if page isn't mapped */
+int arch_page_flags(void *vadr)
+{
+	uint32 *pt, entry;
+
+	if (!(page_dir[PDE_INDEX(vadr)] & ARCH_PAGE_PRESENT))
+		return -1;
+
+	pt = (uint32 *) ENTRY_FRAME(page_dir[PDE_INDEX(vadr)]);
+	entry = pt[PTE_INDEX(vadr)];
+
+	if (!(entry & ARCH_PAGE_PRESENT))
+		return (entry & ARCH_PAGE_GUARD) ? ARCH_PAGE_GUARD : -1;
+
+	return entry & (ARCH_PAGE_WRITE | ARCH_PAGE_COPY);
+}
+
+/*! Remove (empty) page table for region containing 'vadr', return it */
+void *arch_page_table_remove(void *vadr)
+{
+	uint32 pde = page_dir[PDE_INDEX(vadr)];
+
+	if (!(pde & ARCH_PAGE_PRESENT))
+		return NULL;
+
+	page_dir[PDE_INDEX(vadr)] = 0;
+
+	/* reload CR3 - flush all (non global) TLB entries */
+	asm volatile (	"movl %%cr3, %%eax\n\t"
+			"movl %%eax, %%cr3\n\t"
+			::: "eax", "memory");
+
+	return (void *) ENTRY_FRAME(pde);
+}
+
+/*! Return address that caused last page fault */
+void *arch_page_fault_adr()
+{
+	void *adr;
+
+	asm volatile ("movl %%cr2, %0\n\t" : "=r" (adr));
+
+	return adr;
+}
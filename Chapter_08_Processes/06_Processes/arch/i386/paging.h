@@ -0,0 +1,20 @@
+/*! Paging (virtual memory) - i386 page directory and page tables */
+#pragma once
+
+#define ARCH_PAGE_SIZE		0x1000
+#define ARCH_PAGE_TABLE_SPAN	0x400000 /* 1024 pages in one page table */
+
+/* processes are placed between 1 GB and 3 GB (physical memory is below) */
+#define ARCH_PROC_VSTART	0x40000000
+#define ARCH_PROC_VEND		0xC0000000
+#define ARCH_PROC_VSLOT		ARCH_PAGE_TABLE_SPAN /* one page table */
+
+/* page directory and page table entry flags */
+#define ARCH_PAGE_PRESENT	0x001
+#define ARCH_PAGE_WRITE		0x002
+#define ARCH_PAGE_USER		0x004
+#define ARCH_PAGE_COPY		0x200	/* available bit: copy on write */
+#define ARCH_PAGE_GUARD		0x400	/* available bit: guard page */
+
+#define ARCH_CR0_PG		0x80000000
+#define ARCH_CR0_WP		0x00010000 /* read only pages also for kernel */
@@ -15,4 +15,39 @@
 
 #define arch_memory_barrier()		asm ("" : : : "memory")
 
+#include <arch/types.h>
+
+extern uint32 arch_tsc_supported; /* set in startup.S */
+
+/*! processor cycle counter (lower 32 bits of TSC), 0 if not supported */
+static inline uint32 arch_cpu_cycles()
+{
+	uint32 a, d;
+
+	if (!arch_tsc_supported)
+		return 0;
+
+	asm volatile ("rdtsc" : "=a" (a), "=d" (d));
+
+	return a;
+}
+
+/*! whole TSC; caller must check arch_tsc_supported */
+static inline uint64 arch_cpu_tsc()
+{
+	uint32 a, d;
+
+	asm volatile ("rdtsc" : "=a" (a), "=d" (d));
+
+	return ((uint64) d << 32) | a;
+}
+
+/*! atomically store 'value' to '*ptr' and return previous value */
+static inline int arch_atomic_swap(volatile int *ptr, int value)
+{
+	asm volatile ("xchgl %0, %1" : "+r" (value), "+m" (*ptr) : : "memory");
+
+	return value;
+}
+
 #include <arch/processor.h>
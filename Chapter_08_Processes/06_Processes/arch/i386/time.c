@@ -3,6 +3,8 @@
 #include "time.h"
 
 #include <types/time.h>
+#include <arch/processor.h>
+#include <arch/paging.h>
 
 extern arch_timer_t TIMER;
 static arch_timer_t *timer = &TIMER;
@@ -18,6 +20,20 @@ static void (*alarm_handler)(); /* kernel function - call when alarm given by
 
 static void arch_timer_handler(); /* whenever timer expires call this */
 
+/*
+ * Clock page, mapped (read only) into processes: time is updated whenever
+ * 'clock' changes; TSC frequency ('mult') is measured against timer over
+ * intervals of at least CALIBRATE_NS
+ */
+static uint8 clock_frame[PAGE_SIZE] __attribute__ ((aligned (PAGE_SIZE)));
+static clock_page_t *cpage = NULL; /* NULL if there is no TSC */
+static timespec_t cal_time;	/* start of calibration interval */
+static uint64 cal_tsc;
+
+#define CALIBRATE_NS	100000000L
+
+static void clock_page_update(int restart);
+
 void arch_enable_timer_interrupt()	{ timer->enable_interrupt();	}
 void arch_disable_timer_interrupt()	{ timer->disable_interrupt();	}
 
@@ -45,9 +61,85 @@ void arch_timer_init()
 	if (timer->min_interval.tv_sec % 2)
 		threshold.tv_nsec += 1000000000L / 2; /* + half second */
 
+	if (arch_tsc_supported)
+	{
+		cpage = (void *) clock_frame;
+		cpage->seq = 0;
+		clock_page_update(TRUE);
+	}
+
 	return;
 }
 
+/*! Get clock page, NULL if processor doesn't have TSC */
+clock_page_t *arch_clock_page()
+{
+	return cpage;
+}
+
+/*! Calculate n / d (only when result fits in 32 bits: n >> 32 < d) */
+static inline uint32 div64_32(uint64 n, uint32 d)
+{
+	uint32 q, r;
+
+	asm ("divl %4" : "=a" (q), "=d" (r)
+		       : "a" ((uint32) n), "d" ((uint32) (n >> 32)), "rm" (d));
+
+	return q;
+}
+
+/*!
+ * Store current time and TSC into clock page; recalculate TSC frequency
+ * \param restart Start new calibration (time was set or interval overflowed)
+ */
+static void clock_page_update(int restart)
+{
+	timespec_t now, diff;
+	uint64 tsc, cycles;
+	uint32 ns;
+
+	if (!cpage)
+		return;
+
+	arch_get_time(&now);
+	tsc = arch_cpu_tsc();
+
+	cpage->seq++; /* odd - readers must retry */
+	arch_memory_barrier();
+
+	diff = now;
+	time_sub(&diff, &cal_time);
+	cycles = tsc - cal_tsc;
+
+	if (restart || diff.tv_sec > 3 || (cycles >> 32))
+	{
+		/* 32 bit values can't hold interval */
+		cpage->valid = FALSE;
+		cal_time = now;
+		cal_tsc = tsc;
+	}
+	else if (diff.tv_sec > 0 || diff.tv_nsec >= CALIBRATE_NS)
+	{
+		ns = diff.tv_sec * 1000000000UL + diff.tv_nsec;
+
+		/* mult = ns << SHIFT / cycles (not for TSC below ~4 MHz) */
+		if ((ns >> (32 - CLOCK_PAGE_SHIFT)) < (uint32) cycles)
+		{
+			cpage->mult = div64_32((uint64) ns << CLOCK_PAGE_SHIFT,
+						(uint32) cycles);
+			cpage->valid = TRUE;
+		}
+		cal_time = now;
+		cal_tsc = tsc;
+	}
+
+	cpage->time = now;
+	cpage->tsc = tsc;
+
+	arch_memory_barrier();
+	cpage->seq++;
+}
+
 /*!
  * Set next timer activation
  * \param time Time of next activation
@@ -73,6 +165,8 @@ void arch_timer_set(timespec_t *time, void *alarm_func)
 		last_load = delay;
 
 	timer->set_interval(&last_load);
+
+	clock_page_update(FALSE);
 }
 
 /*!
@@ -103,6 +197,8 @@ void arch_set_time(timespec_t *time)
 	last_load = timer->max_interval;
 	timer->set_interval(&last_load);
 
+	clock_page_update(TRUE);
+
 	/* let kernel handle time shift problems */
 	if (alarm_handler)
 	{
@@ -122,6 +218,8 @@ static void arch_timer_handler()
 
 	time_add(&clock, &last_load);
 
+	clock_page_update(FALSE);
+
 	if (alarm_handler)
 	{
 		time_sub(&delay, &last_load);
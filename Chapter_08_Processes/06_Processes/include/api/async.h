@@ -0,0 +1,104 @@
+/*! Asynchronous tasks: stackless coroutines run from an event loop */
+
+#pragma once
+
+#include <types/basic.h>
+#include <types/time.h>
+#include <types/io.h>
+#include <types/pthread.h>
+#include <lib/list.h>
+
+/*
+ * Task is a function that is called again (from event loop) each time what
+ * it waited for happened; it continues from where it stopped (line saved in
+ * task). Local variables are not preserved between calls (keep them in
+ * task parameter), and only one ASYNC_* wait may be placed in a line.
+ *
+ * int reader(async_t *task)
+ * {
+ *	ASYNC_BEGIN(task);
+ *	ASYNC_AWAIT_FD(task, fd, POLLIN, 1000);
+ *	if (!task->result) ... timeout
+ *	ASYNC_END(task);
+ * }
+ */
+
+#define ASYNC_WAIT	0	/* task is suspended */
+#define ASYNC_DONE	1	/* task is finished */
+
+struct _async_loop_t_;
+
+typedef struct _async_t_
+{
+	int	line;		/* where to continue (0 - from start) */
+	int   (*func)(struct _async_t_ *task);
+	void   *param;
+	void  (*done)(struct _async_t_ *task); /* completion callback */
+	int	result;		/* of last wait: revents, message size,
+				   0 on timeout, -1 on error */
+	int	retval;		/* set with ASYNC_RETURN */
+
+	/* internal: what task waits for */
+	struct _async_loop_t_ *loop;
+	int	waits;
+	int	fd, events;
+	mqd_t	mq;
+	char   *msg;
+	size_t	msg_len;
+	timespec_t wake;
+	int	heap_pos;
+	list_h	list;
+}
+async_t;
+
+typedef struct _async_loop_t_
+{
+	int	tasks;		/* started, not finished */
+	list_t	ready;
+	list_t	fd_wait;
+	list_t	mq_wait;
+
+	async_t **heap;		/* timers (by wake time) */
+	int	heap_size, heap_max;
+
+	struct pollfd *fds;
+	async_t **fds_task;
+	int	fds_max;
+}
+async_loop_t;
+
+#define ASYNC_BEGIN(T)		switch ((T)->line) { case 0:
+
+#define ASYNC_END(T)		} (T)->line = 0; return ASYNC_DONE
+
+#define ASYNC_RETURN(T, V)	\
+do { (T)->retval = (V); (T)->line = 0; return ASYNC_DONE; } while (0)
+
+#define ASYNC_SUSPEND(T, WAIT)	\
+do { (T)->line = __LINE__; WAIT; return ASYNC_WAIT; case __LINE__:; } while (0)
+
+/*! let other ready tasks run */
+#define ASYNC_YIELD(T)		ASYNC_SUSPEND(T, async_wait_ready(T))
+
+/*! wait 'MS' milliseconds */
+#define ASYNC_SLEEP(T, MS)	ASYNC_SUSPEND(T, async_wait_time(T, MS))
+
+/*! wait for poll events on descriptor, at most 'MS' ms (-1: no timeout) */
+#define ASYNC_AWAIT_FD(T, FD, EV, MS)	\
+	ASYNC_SUSPEND(T, async_wait_fd(T, FD, EV, MS))
+
+/*! receive message from queue opened with O_NONBLOCK, at most 'MS' ms */
+#define ASYNC_AWAIT_MQ(T, MQ, BUF, LEN, MS)	\
+	ASYNC_SUSPEND(T, async_wait_mq(T, MQ, BUF, LEN, MS))
+
+int async_loop_init(async_loop_t *loop, int timers_max, int fds_max);
+void async_loop_destroy(async_loop_t *loop);
+void async_start(async_loop_t *loop, async_t *task, int (*func)(async_t *),
+		   void *param, void (*done)(async_t *));
+int async_run(async_loop_t *loop);
+
+/* used from ASYNC_* macros */
+void async_wait_ready(async_t *task);
+void async_wait_time(async_t *task, int ms);
+void async_wait_fd(async_t *task, int fd, int events, int ms);
+void async_wait_mq(async_t *task, mqd_t mq, char *buf, size_t len, int ms);
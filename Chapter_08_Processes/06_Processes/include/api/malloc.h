@@ -19,10 +19,14 @@ extern process_t *_uproc_;
 
 #define MEM_ALLOC_T gma_t
 
-#define	mem_init(segment, size)		gma_init(segment, size, 32, 0)
-#define	malloc(size)			gma_alloc(_uproc_->mpool, size)
+#define	mem_init(segment, size)		\
+	gma_init(segment, size, 32, GMA_EXTENDABLE)
+#define	malloc(size)			mem_alloc(size)
 #define	free(addr)			gma_free(_uproc_->mpool, addr)
 
+/* pool is extended with heap growth (sbrk) when there is not enough memory */
+void *mem_alloc(size_t size);
+
 #else /* memory allocator not selected! */
 
 #define	mem_init			k_mem_init_Not_Implemented
@@ -30,3 +34,7 @@ extern process_t *_uproc_;
 #define	free				k_mem_free_Not_Implemented
 
 #endif
+
+/*! process heap end (break) */
+int brk(void *addr);
+void *sbrk(ssize_t increment);
@@ -34,6 +34,10 @@ typedef struct _program_t_
 	size_t  heap_size;
 	size_t  stack_size;
 	size_t  thread_stack;
+
+	/* read only part of program (page aligned): [text, data) */
+	void   *text;
+	void   *data;
 }
 program_t;
 
@@ -49,6 +53,8 @@ typedef struct _process_t_
 	void   *stack;
 	void   *mpool;
 
+	void   *clock;		/* clock page (clock_page_t), if available */
+
 	//void   *heap_brk;
 
 	/*
@@ -63,8 +69,13 @@ process_t;
  * +--------------------------------------------------------------------------+
  * |                       program_t header + process_t exp.                  |
  * +--------------------------------------------------------------------------+
- * |                .text, .*data*, .bss, ... (compiled sections)             |
+ * |                .text, .rodata (read only, shared between processes)      |
+ * +--------------------------------------------------------------------------+
+ * |                .data (private, copied on first write)                    |
+ * +--------------------------------------------------------------------------+
+ * |                .bss (not in ELF file, zero filled on first access)       |
  * +--------------------------------------------------------------------------+
  *
- * Heap and stack are added when program is started and becomes process
+ * Heap and stack are added when program is started and becomes process;
+ * last page of process segment is clock page (read only, shared)
  */
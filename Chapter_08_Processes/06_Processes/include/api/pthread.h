@@ -27,6 +27,10 @@ int pthread_getschedparam(pthread_t thread, int *policy,
 int posix_spawn(pid_t *pid, char *path, void *file_actions,
 		  void *attrp, char *argv[], char *envp[]);
 
+/*! Wait for child process to finish */
+int waitpid(pid_t *pid, int *status, int options);
+int wait4(pid_t *pid, int *status, int options, rusage_t *usage);
+
 /*! Mutex */
 int pthread_mutex_init(pthread_mutex_t *mutex, pthread_mutexattr_t *attr);
 int pthread_mutex_destroy(pthread_mutex_t * mutex);
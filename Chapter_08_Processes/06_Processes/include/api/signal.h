@@ -2,8 +2,14 @@
 #pragma once
 
 #include <types/signal.h>
+#include <arch/context.h>
 
 int sigaction(int sig, sigaction_t *act, sigaction_t *oact);
 int sigwaitinfo(sigset_t *set, siginfo_t *info);
+int sigtimedwait(sigset_t *set, siginfo_t *info, timespec_t *timeout);
 int sigqueue(pid_t pid, int signo, sigval_t sigval);
 int pthread_sigmask(int how, sigset_t *set, sigset_t *oset);
+int sigswitch(ucontext_t *from, ucontext_t *to, void *stack, size_t size);
+
+/* in stdio.c, with other descriptors */
+int signalfd(int fd, sigset_t *mask, int flags);
@@ -0,0 +1,45 @@
+/*! User threads: many user threads multiplexed over few kernel threads
+ *  (preempted when time slice expires) */
+
+#pragma once
+
+#include <types/basic.h>
+
+#ifndef _UTHREAD_C_
+
+typedef void uthread_t;
+
+#else
+
+#include <lib/list.h>
+#include <arch/context.h>
+
+struct _uworker_t_;
+
+typedef struct _uthread_t_
+{
+	int id;
+	ucontext_t context;
+	void *stack;		/* pooled, uthread_t is at its end */
+	int state;		/* UTHREAD_READY or UTHREAD_EXITED */
+	volatile int nopreempt;	/* in runtime code (don't switch it) */
+	struct _uworker_t_ *worker;	/* kernel thread that runs it */
+	list_h list;
+}
+uthread_t;
+
+#endif /* _UTHREAD_C_ */
+
+/*! maximum number of kernel threads (workers) */
+#define UTHREAD_WORKERS_MAX	8
+
+int uthreads_init(int workers);
+int uthreads_run();
+
+uthread_t *create_uthread(void (func)(void *), void *param);
+void uthread_exit();
+void uthread_yield();
+void uthread_preempt();
+
+void uthread_block_begin();
+void uthread_block_end();
@@ -41,4 +41,16 @@ static inline void arch_create_uthread_context(
 
 static inline void arch_switch_to_uthread(ucontext_t *from, ucontext_t *to);
 
+/*!
+ * Switching user threads from signal handler (in kernel, for sigswitch):
+ * interrupted context is saved on its stack (ARCH_UCONTEXT_FRAME bytes below
+ * its stack pointer, which must be committed) in a frame which
+ * arch_switch_to_uthread can resume (through ARCH_UCONTEXT_RESUME function if
+ * arch requires one), and context saved by arch_switch_to_uthread is loaded
+ */
+void *arch_context_get_stack(context_t *context);
+void arch_context_save_uthread(context_t *context, ucontext_t *from,
+				void *resume);
+int arch_context_load_uthread(context_t *context, ucontext_t *to);
+
 #include <ARCH/context.h> /* for context_t and ucontext_t */
@@ -30,6 +30,8 @@ struct _device_t_
 	int  (*send)   (void *data, size_t size, uint flags, device_t *dev);
 	int  (*recv)   (void *data, size_t size, uint flags, device_t *dev);
 	int  (*status) (uint flags, device_t *dev);
+	int  (*info)   (device_t *dev);
+		/* print device statistics on console (optional) */
 
 	/* various flags and parameters specific to device */
 	int     flags;
@@ -18,6 +18,13 @@ void arch_unregister_interrupt_handler(
 	void *device
 );
 
+/*!
+ * Register kernel function to be called on exit from each interrupt
+ * (after interrupt handlers), with arguments: interrupt number and
+ * time (timespec_t *) when interrupt processing started
+ */
+void arch_register_interrupt_exit_handler(void *handler);
+
 /*! Quit startup thread and start with created one (=> arch_select_thread) */
 void arch_return_to_thread();
 
@@ -1,5 +1,16 @@
 /*! Modules, memory segments */
 #pragma once
+
+/*! modules in system images */
+/* magic numbers for headers */
+#define PMAGIC1		0x11235813
+#define PMAGIC2		0x16180334
+
+/* module with program files (ELF), created in boot/ramdisk.S */
+#define MS_RAMDISK	9
+
+#ifndef ASM_FILE
+
 #include <api/prog_info.h>
 
 /* memory segments/module types */
@@ -24,11 +35,6 @@ mseg_t;
 mseg_t *arch_memory_init();
 
 
-/*! modules in system images */
-/* magic numbers for headers */
-#define PMAGIC1		0x11235813
-#define PMAGIC2		0x16180334
-
 /* Modules loaded with kernel */
 typedef struct _module_t_
 {
@@ -36,7 +42,7 @@ typedef struct _module_t_
 		/* magic numbers to identify start of module */
 
 	uint32  type;
-		/* MS_PROGRAM, MS_OTHER */
+		/* MS_PROGRAM, MS_RAMDISK, MS_OTHER */
 
 	/* for calculating size */
 	void   *start;
@@ -63,6 +69,17 @@ typedef struct program_loaded_as_module
 }
 module_program_t;
 
+/*! Ramdisk: module_t header, directory (ramdisk_file_t array, ended with
+ *  zero sized element), files (each at page aligned offset) */
+typedef struct _ramdisk_file_t_
+{
+	uint32  offset;
+		/* file offset from ramdisk start */
+	uint32  size;
+		/* file size */
+}
+ramdisk_file_t;
+
 /*
  * Memory map of module: (addresses grows downward!)
  * +--------------------------------------------------------------------------+
@@ -79,3 +96,5 @@ module_program_t;
  * |                .text, .*data*, .bss, ... (compiled sections)             |
  * +--------------------------------------------------------------------------+
  */
+
+#endif /* ASM_FILE */
@@ -21,3 +21,58 @@
 #define MULTIBOOT_BOOTLOADER_MAGIC	0x2BADB002
 
 /* Since other multiboot options aren't used they are not present here */
+
+/* Flags set by boot loader in multiboot information structure */
+#define MULTIBOOT_INFO_MEMORY		0x00000001 /* mem_lower/mem_upper */
+#define MULTIBOOT_INFO_MODS		0x00000008 /* mods_count/mods_addr */
+#define MULTIBOOT_INFO_MEM_MAP		0x00000040 /* mmap_length/mmap_addr */
+
+/* Memory map: available memory region */
+#define MULTIBOOT_MEMORY_AVAILABLE	1
+
+#ifndef ASM_FILE
+
+#include <types/basic.h>
+
+/*! Multiboot information structure (only used fields are described) */
+typedef struct _multiboot_info_t_
+{
+	uint32  flags;
+
+	uint32  mem_lower;	/* memory below 1 MB, in KB */
+	uint32  mem_upper;	/* memory above 1 MB, in KB */
+
+	uint32  boot_device;
+	uint32  cmdline;
+
+	uint32  mods_count;	/* number of loaded modules */
+	uint32  mods_addr;	/* address of first multiboot_module_t */
+
+	uint32  syms[4];
+
+	uint32  mmap_length;	/* size of memory map buffer */
+	uint32  mmap_addr;	/* address of first multiboot_mmap_t */
+}
+multiboot_info_t;
+
+/*! Module loaded by boot loader */
+typedef struct _multiboot_module_t_
+{
+	uint32  mod_start;
+	uint32  mod_end;
+	uint32  string;
+	uint32  reserved;
+}
+multiboot_module_t;
+
+/*! Memory map element ('size' doesn't include 'size' field itself) */
+typedef struct _multiboot_mmap_t_
+{
+	uint32  size;
+	uint32  base_addr_low, base_addr_high;
+	uint32  length_low, length_high;
+	uint32  type;
+}
+__attribute__((packed)) multiboot_mmap_t;
+
+#endif /* ASM_FILE */
@@ -0,0 +1,54 @@
+/*! Paging (virtual memory) - interface to 'arch' layer */
+#pragma once
+
+#include <types/basic.h>
+#include <ARCH/paging.h>
+
+#define PAGE_SIZE		ARCH_PAGE_SIZE
+
+/*! address space reserved for processes (above physical memory) */
+#define PROC_VSTART		ARCH_PROC_VSTART
+#define PROC_VEND		ARCH_PROC_VEND
+
+/*! granularity for process address space */
+#define PROC_VSLOT		ARCH_PROC_VSLOT
+
+/*! address space covered by one page table (arch_page_table_remove) */
+#define PAGE_TABLE_SPAN		ARCH_PAGE_TABLE_SPAN
+
+/*! page flags */
+#define PAGE_READ		0
+#define PAGE_WRITE		ARCH_PAGE_WRITE
+#define PAGE_COPY		ARCH_PAGE_COPY	/* read only, copy on write */
+#define PAGE_GUARD		ARCH_PAGE_GUARD	/* not present, never mapped */
+
+/*!
+ * Create identity mapping for [0, mem_end) and turn paging on
+ * \param frame_alloc Function that returns free page frame (or NULL)
+ * \param mem_end End of physical memory
+ */
+void arch_paging_init(void *(*frame_alloc)(), void *mem_end);
+
+/*!
+ * Map page frame to virtual address
+ * \param vadr Virtual address (page aligned)
+ * \param frame Page frame (physical address), NULL for PAGE_GUARD
+ * \param flags PAGE_READ, PAGE_WRITE, PAGE_COPY or PAGE_GUARD
+ * \return 0 if successful, ENOMEM if page table couldn't be created
+ */
+int arch_page_map(void *vadr, void *frame, int flags);
+
+/*! Remove mapping for page on 'vadr', return its frame (NULL if unmapped) */
+void *arch_page_unmap(void *vadr);
+
+/*! Return frame mapped on 'vadr', NULL if page isn't present */
+void *arch_page_frame(void *vadr);
+
+/*! Return flags of page on 'vadr' (PAGE_*), -1 if page isn't mapped */
+int arch_page_flags(void *vadr);
+
+/*! Remove (empty) page table for region containing 'vadr', return it */
+void *arch_page_table_remove(void *vadr);
+
+/*! Return address that caused last page fault */
+void *arch_page_fault_adr();
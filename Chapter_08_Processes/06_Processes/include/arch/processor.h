@@ -19,3 +19,12 @@
 
 /*! memory barrier */
 #define memory_barrier()	arch_memory_barrier()
+
+/*! atomic exchange (for locks in user space) */
+#define atomic_swap(p, v)	arch_atomic_swap(p, v)
+
+/*! processor cycle counter (for measuring short intervals) */
+#define cpu_cycles()		arch_cpu_cycles()
+
+/*! whole (64-bit) processor cycle counter, without support check */
+#define cpu_tsc()		arch_cpu_tsc()
@@ -28,6 +28,12 @@ void arch_get_time(timespec_t *time);
  */
 void arch_set_time(timespec_t *time);
 
+/*!
+ * Get clock page (page aligned, updated by arch layer on every timer change)
+ * \return page address, NULL if processor doesn't have TSC
+ */
+clock_page_t *arch_clock_page();
+
 /*! Get minimal timer interval supported by hardware timer */
 void arch_get_min_interval(timespec_t *time);
 
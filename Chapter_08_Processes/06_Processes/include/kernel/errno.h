@@ -33,10 +33,12 @@ do { int ec=ENUM; SET_ERRNO(ec); return (ec ? EXIT_FAILURE : 0); } while (0)
 
 /* Debugging outputs (includes files and line numbers!) */
 #define LOG(LEVEL, format, ...)	\
-kprintf("[" #LEVEL ":%s:%d]" format "\n", __FILE__, __LINE__, ##__VA_ARGS__)
+klog(KLOG_ ## LEVEL, "[" #LEVEL ":%s:%d]" format "\n", __FILE__, __LINE__, \
+	##__VA_ARGS__)
 
 /* Critical error - print it and stop */
-#define ASSERT(expr)	do if (!(expr)) { LOG(BUG, ""); halt(); } while (0)
+#define ASSERT(expr)	\
+do if (!(expr)) { LOG(BUG, ""); kprint_flush(); halt(); } while (0)
 
 /* assert and return (inter kernel calls) */
 #define ASSERT_AND_RETURN_ERRNO(expr, errnum)		\
@@ -58,10 +60,12 @@ do if (!(expr)) { LOG(ASSERT, ""); EXIT(errnum); } while (0)
 /*! macros that are not removed in release versions - don't depend on DEBUG */
 /* Debugging outputs (includes files and line numbers!) */
 #define log(LEVEL, format, ...)	\
-kprintf("[" #LEVEL ":%s:%d]" format "\n", __FILE__, __LINE__, ##__VA_ARGS__)
+klog(KLOG_ ## LEVEL, "[" #LEVEL ":%s:%d]" format "\n", __FILE__, __LINE__, \
+	##__VA_ARGS__)
 
 /* Critical error - print it and stop */
-#define assert(expr)	do if (!(expr)) { log(BUG, ""); halt(); } while (0)
+#define assert(expr)	\
+do if (!(expr)) { log(BUG, ""); kprint_flush(); halt(); } while (0)
 
 /* assert and return (inter kernel calls) */
 #define assert_and_return_errno(expr, errnum)		\
@@ -5,6 +5,26 @@
 
 #include <types/io.h>
 
+/*! Log levels (lower number - more important message) */
+enum {
+	KLOG_BUG = 0,	/* critical errors - system will be stopped */
+	KLOG_ASSERT,	/* failed checks */
+	KLOG_ERROR,
+	KLOG_WARN,
+	KLOG_INFO,
+	KLOG_DEBUG,
+	KLOG_PRINT	/* plain output (kprintf) - no timestamp, not filtered */
+};
+
+/* size of buffer for kernel messages (waiting to be printed) */
+#ifndef KPRINT_BUFFER_SIZE
+#define KPRINT_BUFFER_SIZE	4096
+#endif
+
 int kprintf(char *format, ...);
+int klog(int level, char *format, ...);
+int klog_set_level(int level);
+void kprint_drain();
+void kprint_flush();
 
 #endif /* _KERNEL_ */
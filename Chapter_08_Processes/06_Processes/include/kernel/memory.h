@@ -3,6 +3,7 @@
 
 /*! interface to threads (via syscall) */
 int sys__sysinfo(void *p);
+int sys__brk(void *p);
 
 #ifdef _KERNEL_ /* (for kernel and arch layer) */
 
@@ -12,6 +12,7 @@ int sys__pthread_self(void *p);
 int sys__pthread_setschedparam(void *p);
 
 int sys__posix_spawn(void *p);
+int sys__waitpid(void *p);
 
 int sys__pthread_mutex_init(void *p);
 int sys__pthread_mutex_destroy(void *p);
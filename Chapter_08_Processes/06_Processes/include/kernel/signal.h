@@ -14,5 +14,13 @@ int sys__pthread_sigmask(void *p);
 /*int sys__sigaction(int sig, sigaction_t *act, sigaction_t *oact);*/
 int sys__sigaction(void *p);
 
-/*int sys__sigwaitinfo(sigset_t *set, siginfo_t *info);*/
-int sys__sigwaitinfo(void *p);
+/*int sys__sigtimedwait(sigset_t *set, siginfo_t *info,
+			timespec_t *timeout);*/
+int sys__sigtimedwait(void *p);
+
+/*int sys__signalfd(descriptor_t *desc, sigset_t *mask, int flags);*/
+int sys__signalfd(void *p);
+
+/*int sys__sigswitch(ucontext_t *from, ucontext_t *to, void *stack,
+			size_t size, void *resume);*/
+int sys__sigswitch(void *p);
@@ -7,6 +7,7 @@ enum {
 
 	SYSINFO,
 	SYSFEATURE,
+	BRK,
 
 	SET_ERRNO,
 	GET_ERRNO,
@@ -58,9 +59,12 @@ enum {
 	SIGACTION,
 	PTHREAD_SIGMASK,
 	SIGQUEUE,
-	SIGWAITINFO,
+	SIGTIMEDWAIT,
+	SIGNALFD,
+	SIGSWITCH,
 
 	POSIX_SPAWN,
+	WAITPID,
 
 	SYSFUNCS
 };
@@ -177,6 +177,9 @@
 
 #include <types/basic.h>
 
+/*! flags for gma_init */
+#define GMA_EXTENDABLE	2	/* pool can be extended with gma_add_segment */
+
 /*! interface to kernel and other code (not for gma.c) */
 #ifndef _GMA_C_
 
@@ -186,6 +189,7 @@ gma_t *gma_init(void *memory_segment, size_t size, size_t min_chunk_size,
 		    uint flags);
 void *gma_alloc(gma_t *mpool, size_t size);
 int gma_free(gma_t *mpool, void *address);
+int gma_add_segment(gma_t *mpool, void *memory_segment, size_t size);
 
 #else /* _GMA_C_ */
 
@@ -233,11 +237,11 @@ typedef struct _gma_t_
 		      /* 2-level array list headers  */
 		      /* chunk[i][j] is of type (mchunk_t *) */
 
-	/*
-	 * for future extend and shrink operations:
-	   void *pool;
-	   size_t size;
-	 */
+	uint          flags;
+		      /* flags given in gma_init */
+
+	size_t        end;
+		      /* end of last segment added to pool */
 }
 gma_t;
 
@@ -474,6 +478,7 @@ gma_t *gma_init(void *memory_segment, size_t size, size_t min_chunk_size,
 		  uint flags);
 void *gma_alloc(gma_t *mpool, size_t size);
 int gma_free(gma_t *mpool, void *address);
+int gma_add_segment(gma_t *mpool, void *memory_segment, size_t size);
 
 static int get_indexes(gma_t *mpool,size_t size,size_t *fl,size_t *sl,int ins);
 static inline void set_list_have_chunks(gma_t *mpool, size_t fl, size_t sl);
@@ -485,7 +490,6 @@ static mchunk_t *remove_first_chunk_from_free_list(gma_t *mpool, size_t fl,
 						     size_t sl);
 
 /* ToDo:
-   int extend_mpool(gma_t *mpool, size_t size_to_add_to_the_end_of_mpool);
    int shrink_mpool(gma_t *mpool, size_t size_at_end_of_mpool_to_release);
 */
 #endif /* _GMA_C_ */
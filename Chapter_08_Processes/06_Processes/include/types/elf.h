@@ -0,0 +1,112 @@
+/*! ELF32 file format (only parts used by program loader) */
+#pragma once
+
+#include <types/basic.h>
+
+/*! File header */
+#define EI_NIDENT	16
+
+typedef struct _elf32_ehdr_t_
+{
+	uint8	e_ident[EI_NIDENT];
+		/* magic number, class, data encoding, version, ... */
+	uint16	e_type;
+	uint16	e_machine;
+	uint32	e_version;
+	uint32	e_entry;
+	uint32	e_phoff;
+		/* program header table offset */
+	uint32	e_shoff;
+	uint32	e_flags;
+	uint16	e_ehsize;
+	uint16	e_phentsize;
+	uint16	e_phnum;
+		/* program header table entry size and count */
+	uint16	e_shentsize;
+	uint16	e_shnum;
+	uint16	e_shstrndx;
+}
+elf32_ehdr_t;
+
+/* e_ident */
+#define ELFMAG0		0x7f
+#define ELFMAG1		'E'
+#define ELFMAG2		'L'
+#define ELFMAG3		'F'
+#define EI_CLASS	4
+#define ELFCLASS32	1
+#define EI_DATA		5
+#define ELFDATA2LSB	1
+
+/* e_type */
+#define ET_EXEC		2
+#define ET_DYN		3
+
+/* e_machine */
+#define EM_386		3
+#define EM_ARM		40
+
+/*! Program header (segment descriptor) */
+typedef struct _elf32_phdr_t_
+{
+	uint32	p_type;
+	uint32	p_offset;
+		/* segment offset in file */
+	uint32	p_vaddr;
+		/* segment (link) address */
+	uint32	p_paddr;
+	uint32	p_filesz;
+		/* size in file */
+	uint32	p_memsz;
+		/* size in memory; rest after p_filesz is zero filled */
+	uint32	p_flags;
+	uint32	p_align;
+}
+elf32_phdr_t;
+
+/* p_type */
+#define PT_LOAD		1
+#define PT_DYNAMIC	2
+
+/*! Dynamic section entry */
+typedef struct _elf32_dyn_t_
+{
+	int32	d_tag;
+	uint32	d_val;
+}
+elf32_dyn_t;
+
+/* d_tag */
+#define DT_NULL		0
+#define DT_REL		17
+#define DT_RELSZ	18
+#define DT_RELENT	19
+
+/*! Relocation entry (without addend) */
+typedef struct _elf32_rel_t_
+{
+	uint32	r_offset;
+		/* (link) address to relocate */
+	uint32	r_info;
+		/* relocation type and symbol index */
+}
+elf32_rel_t;
+
+#define ELF32_R_TYPE(INFO)	((INFO) & 0xff)
+
+/* relocation types */
+#define R_386_NONE	0
+#define R_386_RELATIVE	8
+#define R_ARM_NONE	0
+#define R_ARM_RELATIVE	23
+
+/* machine and relocation types of architecture kernel is built for */
+#ifdef __arm__
+#define ELF_MACHINE	EM_ARM
+#define ELF_R_NONE	R_ARM_NONE
+#define ELF_R_RELATIVE	R_ARM_RELATIVE
+#else
+#define ELF_MACHINE	EM_386
+#define ELF_R_NONE	R_386_NONE
+#define ELF_R_RELATIVE	R_386_RELATIVE
+#endif
@@ -32,6 +32,8 @@
 #define DEV_TYPE_SHARED		(1 << 28)
 #define DEV_TYPE_NOTSHARED	(1 << 29)
 #define DEV_TYPE_CONSOLE	(1 << 30)	/* "console mode" = text mode */
+#define DEV_TYPE_KERNEL		(1 << 27)	/* kernel object (no driver),
+						 * e.g. signalfd */
 
 /*! limits for name lengths of named system objects (as message queues) */
 #define	PATH_MAX		255
@@ -2,11 +2,25 @@
 #pragma once
 
 #include <types/basic.h>
+#include <types/time.h>
 
 /*! POSIX thread descriptor (user space) */
 typedef descriptor_t pthread_t;
 typedef pthread_t pid_t;
 
+/*! Resources used by finished process (returned with wait4) */
+typedef struct rusage
+{
+	timespec_t  ru_utime;
+		    /* processor time used by all process threads */
+	long	    ru_maxrss;
+		    /* peak memory used by process (in kB) */
+}
+rusage_t;
+
+/* options for waitpid */
+#define	WNOHANG		(1<<0)
+
 /*! Scheduling parameters */
 typedef struct sched_param
 {
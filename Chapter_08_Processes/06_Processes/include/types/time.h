@@ -29,6 +29,24 @@ typedef descriptor_t timer_t;
 
 #define TIMER_ABSTIME	1
 
+/*!
+ * Clock page: system time published by kernel, mapped read only into every
+ * process, so time can be read without system call:
+ *   now = time + ((cpu_tsc() - tsc) * mult >> CLOCK_PAGE_SHIFT) ns
+ * 'seq' is odd while kernel updates page; reader repeats if 'seq' changed
+ */
+typedef struct _clock_page_t_
+{
+	volatile uint32 seq;
+	volatile uint32 valid;	/* FALSE until TSC frequency is measured */
+	timespec_t	time;	/* system time when TSC had value 'tsc' */
+	uint64		tsc;
+	uint32		mult;	/* nanoseconds per cycle << CLOCK_PAGE_SHIFT */
+}
+clock_page_t;
+
+#define CLOCK_PAGE_SHIFT	24
+
 #define TIME_IS_SET(T)	((T)->tv_sec + (T)->tv_nsec != 0)
 #define TIME_RESET(T)	do {(T)->tv_sec = (T)->tv_nsec = 0; } while (0)
 
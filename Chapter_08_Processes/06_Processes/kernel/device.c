@@ -7,11 +7,23 @@
 #include "memory.h"
 #include <arch/interrupt.h>
 #include <arch/processor.h>
+#include <arch/syscall.h>
 #include <lib/string.h>
 
 static list_t devices;
 
+/*! period (in ms) of checking devices that don't report changes in poll */
+#define POLL_RECHECK	10
+
 static void k_device_interrupt_handler(unsigned int inum, void *device);
+static int k_device_event(int irq_num, void *device);
+static int kdevice_release_rw(kthread_q *q, int op, int ready,
+				 kdevice_t *kdev);
+static int kdevice_poll_check(kpoll_t *kpoll, kprocess_t *proc);
+static void kdevice_poll_release(kpoll_t *kpoll);
+static void kdevice_poll_timeout(sigval_t sigval);
+static void kdevice_poll_interrupt(kthread_t *kthread, void *param);
+static void kdevice_release_all(kdevice_t *kdev, int errno);
 
 /*! Initialize initial device as console for system boot messages */
 void kdevice_set_initial_stdout()
@@ -38,7 +50,7 @@ int k_devices_init()
 	for (iter = 0; dev[iter] != NULL; iter++)
 	{
 		kdev = k_device_add(dev[iter]);
-		k_device_init(kdev, 0, NULL, NULL);
+		k_device_init(kdev, 0, NULL, k_device_event);
 	}
 
 	return 0;
@@ -55,7 +67,7 @@ kdevice_t *k_device_add(device_t *dev)
 	ASSERT(kdev);
 
 	kdev->dev = *dev;
-	kdev->id = k_new_id();
+	kdev->id = k_new_id(KTYPE_DEVICE, kdev);
 	kdev->flags = 0;
 
 	list_append(&devices, kdev, &kdev->list);
@@ -77,6 +89,10 @@ int k_device_init(kdevice_t *kdev, int flags, void *params, void *callback)
 		kdev->dev.params = params;
 
 	list_init(&kdev->descriptors);
+	list_init(&kdev->pollers);
+	kthreadq_init(&kdev->readq);
+	kthreadq_init(&kdev->writeq);
+	kdev->notify = FALSE;
 
 	if (kdev->dev.init)
 		retval = kdev->dev.init(flags, params, &kdev->dev);
@@ -87,6 +103,7 @@ int k_device_init(kdevice_t *kdev, int flags, void *params, void *callback)
 							 k_device_interrupt_handler,
 							 kdev);
 		arch_irq_enable(kdev->dev.irq_num);
+		kdev->notify = TRUE;
 	}
 
 	if (callback)
@@ -95,6 +112,41 @@ int k_device_init(kdevice_t *kdev, int flags, void *params, void *callback)
 	return retval;
 }
 
+/*!
+ * Create device for kernel object that is accessed through descriptors
+ * (read/poll), but has no driver (DEV_TYPE_KERNEL in 'dev->flags');
+ * device is opened and removed on last close
+ * \param dev Device interface (copied)
+ * \param params Device parameters (dev->params)
+ * \return created device
+ */
+kdevice_t *k_device_create(device_t *dev, void *params)
+{
+	kdevice_t *kdev;
+
+	ASSERT(dev && (dev->flags & DEV_TYPE_KERNEL));
+
+	kdev = k_device_add(dev);
+	k_device_init(kdev, 0, params, k_device_event);
+
+	kdev->notify = TRUE; /* through k_device_notify */
+	kdev->flags = DEV_OPEN;
+	kdev->ref_cnt = 1;
+
+	return kdev;
+}
+
+/*!
+ * Device (kernel object) status changed: complete read/poll for threads
+ * waiting on it (as when driver calls its callback from interrupt handler)
+ */
+void k_device_notify(kdevice_t *kdev)
+{
+	ASSERT(kdev);
+
+	k_device_event(kdev->dev.irq_num, kdev);
+}
+
 /*! Remove device from list of devices */
 int k_device_remove(kdevice_t *kdev)
 {
@@ -161,7 +213,8 @@ kdevice_t *k_device_open(char *name, int flags)
 	kdev = list_get(&devices, FIRST);
 	while (kdev)
 	{
-		if (!strcmp(name, kdev->dev.dev_name))
+		if (!(kdev->dev.flags & DEV_TYPE_KERNEL) &&
+			!strcmp(name, kdev->dev.dev_name))
 		{
 			if (	(kdev->dev.flags & DEV_TYPE_NOTSHARED) &&
 				(kdev->dev.flags & DEV_OPEN))
@@ -181,6 +234,26 @@ kdevice_t *k_device_open(char *name, int flags)
 	return NULL;
 }
 
+/*! Print devices and their statistics (if device provides them) */
+int k_device_info()
+{
+	kdevice_t *kdev;
+
+	kprintf("Devices info\n");
+
+	kdev = list_get(&devices, FIRST);
+	while (kdev)
+	{
+		kprintf("%s\topened=%d\n", kdev->dev.dev_name, kdev->ref_cnt);
+		if (kdev->dev.info)
+			kdev->dev.info(&kdev->dev);
+
+		kdev = list_get_next(&kdev->list);
+	}
+
+	return 0;
+}
+
 /*! Close device (close exclusive use, if defined) */
 void k_device_close(kdevice_t *kdev)
 {
@@ -189,6 +262,42 @@ void k_device_close(kdevice_t *kdev)
 		kdev->flags &= ~DEV_OPEN;
 
 	/* FIXME: restore flags; use list kdev->descriptors? */
+
+	/* kernel object exists only while it is opened */
+	if (!kdev->ref_cnt && (kdev->dev.flags & DEV_TYPE_KERNEL))
+	{
+		kdevice_release_all(kdev, EBADF);
+		k_device_remove(kdev);
+	}
+}
+
+/*!
+ * Create descriptor for opened device in process 'proc'
+ * \param kdev Opened device
+ * \param flags Opening flags (O_NONBLOCK, ...)
+ * \param desc Where to save descriptor (kernel address)
+ * \param proc Process
+ * \return kernel object which represents device in process
+ */
+kobject_t *k_device_descriptor(kdevice_t *kdev, int flags, descriptor_t *desc,
+				 kprocess_t *proc)
+{
+	kobject_t *kobj;
+
+	kobj = kmalloc_kobject(proc, 0);
+	if (!kobj)
+		return NULL;
+
+	kobj->kobject = kdev;
+	kobj->flags = flags;
+
+	desc->ptr = kobj;
+	desc->id = kdev->id;
+
+	/* add descriptor to device list */
+	list_append(&kdev->descriptors, kobj, &kobj->spec);
+
+	return kobj;
 }
 
 /* common device interrupt handler wrapper */
@@ -206,6 +315,74 @@ static void k_device_interrupt_handler(unsigned int inum, void *device)
 	if (status) {} /* handle return status if required */
 }
 
+/*!
+ * Callback from device driver (interrupt handler) - device status changed
+ * (new data arrived or data was sent); complete read/write/poll for threads
+ * which waited for such event
+ */
+static int k_device_event(int irq_num, void *device)
+{
+	extern void *k_stdout; /* console for kernel messages */
+	kdevice_t *kdev = device; /* 'dev' is first element in kdevice_t */
+	kdevice_poll_t *pwait;
+	kpoll_t *kpoll;
+	int changes, released = 0;
+
+	ASSERT(kdev);
+
+	/* kernel console - continue with printing buffered messages */
+	if (kdev == k_stdout)
+		kprint_drain();
+
+	/* threads blocked in read/write */
+	released += kdevice_release_rw(&kdev->readq, TRUE, DEV_IN_READY, kdev);
+	released += kdevice_release_rw(&kdev->writeq, FALSE, DEV_OUT_READY,
+					 kdev);
+
+	/* threads blocked in poll */
+	pwait = list_get(&kdev->pollers, FIRST);
+	while (pwait)
+	{
+		kpoll = pwait->kpoll;
+		changes = kdevice_poll_check(kpoll,
+					     kthread_get_process(kpoll->kthread));
+
+		if (changes == 0)
+		{
+			pwait = list_get_next(&pwait->list);
+			continue;
+		}
+
+		if (changes > 0)
+			kthread_set_errno(kpoll->kthread, EXIT_SUCCESS);
+		else
+			kthread_set_errno(kpoll->kthread, EINVAL);
+		kthread_set_syscall_retval(kpoll->kthread, changes);
+
+		kthread_move_to_ready(kpoll->kthread, LAST);
+		kdevice_poll_release(kpoll);
+		released++;
+
+		/* released request removed its elements from device list */
+		pwait = list_get(&kdev->pollers, FIRST);
+	}
+
+	if (released)
+		kthreads_schedule();
+
+	return released;
+}
+
+/*!
+ * Can device release threads blocked on it, i.e. does it report status
+ * changes through its callback (its interrupt is enabled, or it is kernel
+ * object that calls k_device_notify)?
+ */
+int k_device_notifies(kdevice_t *kdev)
+{
+	return kdev->notify && kdev->dev.callback;
+}
+
 static int k_device_status(int flags, kdevice_t *kdev)
 {
 	ASSERT(kdev);
@@ -267,23 +444,17 @@ int sys__open(void *p)
 	ASSERT_ERRNO_AND_EXIT(desc, EINVAL);
 	desc = U2K_GET_ADR(desc, proc);
 	ASSERT_ERRNO_AND_EXIT(desc, EINVAL);
+	if (k_memory_commit(proc, desc, sizeof(descriptor_t)))
+		EXIT(ENOMEM);
 
 	kdev = k_device_open(pathname, flags);
 
 	if (!kdev)
 		return EXIT_FAILURE;
 
-	kobj = kmalloc_kobject(proc, 0);
-	ASSERT_ERRNO_AND_EXIT(kobj, ENOMEM);
-
-	kobj->kobject = kdev;
-	kobj->flags = flags;
-
-	desc->ptr = kobj;
-	desc->id = kdev->id;
-
-	/* add descriptor to device list */
-	list_append(&kdev->descriptors, kobj, &kobj->spec);
+	kobj = k_device_descriptor(kdev, flags, desc, proc);
+	if (!kobj)
+		EXIT(ENOMEM);
 
 	EXIT2(EXIT_SUCCESS, EXIT_SUCCESS);
 }
@@ -321,18 +492,53 @@ int sys__close(void *p)
 	EXIT2(EXIT_SUCCESS, EXIT_SUCCESS);
 }
 
-static int read_write(void *p, int op);
+static int sys__read_write(void *p, int op);
+static int read_write(void *p, int op, kthread_t *kthread, size_t done);
 
 int sys__read(void *p)
 {
-	return read_write(p, TRUE);
+	return sys__read_write(p, TRUE);
 }
 int sys__write(void *p)
 {
-	return read_write(p, FALSE);
+	return sys__read_write(p, FALSE);
 }
 
-static int read_write(void *p, int op)
+static int sys__read_write(void *p, int op)
+{
+	kthread_t *kthread;
+	int retval;
+
+	kthread = kthread_get_active();
+
+	retval = read_write(p, op, kthread, 0);
+
+	if (retval >= 0)
+	{
+		kthread_set_errno(kthread, EXIT_SUCCESS);
+	}
+	else {
+		kthread_set_errno(kthread, -retval);
+		retval = EXIT_FAILURE;
+	}
+
+	return retval;
+}
+
+/*!
+ * Read from or write to device; if operation can't be completed (no data
+ * to read or no space in device buffer) and descriptor is not opened with
+ * O_NONBLOCK, thread is blocked in device queue until device signals change
+ * (interrupt handler calls device callback - k_device_event)
+ * \param p Syscall parameters (from thread context)
+ * \param op Operation: TRUE for read, FALSE for write
+ * \param kthread Thread which requested operation
+ * \param done Number of bytes already written (when thread is released)
+ * \return number of bytes read/written, negated errno on errors
+ *
+ * NOTE: returned error numbers are internally negated, as in kmq_receive
+ */
+static int read_write(void *p, int op, kthread_t *kthread, size_t done)
 {
 	descriptor_t *desc;
 	void *buffer;
@@ -347,34 +553,144 @@ static int read_write(void *p, int op)
 	buffer =   *((char **) p);		p += sizeof(char *);
 	size = *((size_t *) p);
 
-	proc = kthread_get_process(NULL);
+	proc = kthread_get_process(kthread);
 
-	ASSERT_ERRNO_AND_EXIT(desc, EINVAL);
+	ASSERT_AND_RETURN_ERRNO(desc, -EINVAL);
 	desc = U2K_GET_ADR(desc, proc);
-	ASSERT_ERRNO_AND_EXIT(desc, EINVAL);
-	ASSERT_ERRNO_AND_EXIT(buffer, EINVAL);
+	ASSERT_AND_RETURN_ERRNO(desc, -EINVAL);
+	ASSERT_AND_RETURN_ERRNO(buffer, -EINVAL);
 	buffer = U2K_GET_ADR(buffer, proc);
-	ASSERT_ERRNO_AND_EXIT(buffer, EINVAL);
-	ASSERT_ERRNO_AND_EXIT(size > 0, EINVAL);
+	ASSERT_AND_RETURN_ERRNO(buffer, -EINVAL);
+	ASSERT_AND_RETURN_ERRNO(size > 0, -EINVAL);
+	/* device writes into buffer on read */
+	if (op ? k_memory_commit(proc, buffer, size) :
+		 k_memory_present(proc, buffer, size))
+		return -ENOMEM;
 
 	kobj = desc->ptr;
-	ASSERT_ERRNO_AND_EXIT(kobj, EINVAL);
-	ASSERT_ERRNO_AND_EXIT(list_find(&proc->kobjects, &kobj->list),
-				EINVAL);
+	ASSERT_AND_RETURN_ERRNO(kobj, -EINVAL);
+	ASSERT_AND_RETURN_ERRNO(list_find(&proc->kobjects, &kobj->list),
+				-EINVAL);
 	kdev = kobj->kobject;
-	ASSERT_ERRNO_AND_EXIT(kdev && kdev->id == desc->id, EINVAL);
+	ASSERT_AND_RETURN_ERRNO(kdev && kdev->id == desc->id, -EINVAL);
 
 	/* TODO check permission for requested operation from opening flags */
 
 	if (op)
 		retval = k_device_recv(buffer, size, kobj->flags, kdev);
 	else
-		retval = k_device_send(buffer, size, kobj->flags, kdev);
+		retval = k_device_send(buffer + done, size - done,
+					 kobj->flags, kdev);
 
-	if (retval >= 0)
-		EXIT2(EXIT_SUCCESS, retval);
-	else
-		EXIT2(EIO, EXIT_FAILURE);
+	if (retval < 0)
+		return -EIO;
+
+	/* only devices that report changes can release blocked thread */
+	if ((kobj->flags & O_NONBLOCK) || !k_device_notifies(kdev))
+		return done + retval;
+
+	if (op && retval == 0)
+	{
+		/* block reader until data arrives */
+		kthread_enqueue(kthread, &kdev->readq, 1, NULL, NULL);
+		kthreads_schedule();
+
+		return -EAGAIN;
+	}
+	else if (!op && done + retval < size &&
+		!(k_device_status(DEV_OUT_READY, kdev) & DEV_OUT_READY))
+	{
+		/* block writer until space in device buffer is available */
+		kthread_set_private_param(kthread, (void *) (done + retval));
+		kthread_enqueue(kthread, &kdev->writeq, 1, NULL, NULL);
+		kthreads_schedule();
+
+		return -EAGAIN;
+	}
+
+	return done + retval;
+}
+
+/*!
+ * Device is ready for reading/writing - release threads blocked in given
+ * queue (repeat operation for them) while device is ready
+ * \param q Queue with blocked threads (readq or writeq)
+ * \param op Operation: TRUE for read, FALSE for write
+ * \param ready Device status flag which must be set for operation
+ * \param kdev Device
+ * \return number of released threads
+ */
+static int kdevice_release_rw(kthread_q *q, int op, int ready,
+				 kdevice_t *kdev)
+{
+	kthread_t *kthread;
+	void *p;
+	size_t done;
+	int status, retval, released = 0;
+
+	while (kthreadq_get(q))
+	{
+		status = k_device_status(ready, kdev);
+		if (status == -1 || !(status & ready))
+			break;
+
+		kthread = kthreadq_remove(q, NULL);
+
+		p = arch_syscall_get_params(kthread_get_context(kthread));
+		done = op ? 0 : (size_t) kthread_get_private_param(kthread);
+
+		retval = read_write(p, op, kthread, done);
+
+		if (retval == -EAGAIN)
+			continue; /* blocked again - nothing more to do for now */
+
+		if (retval >= 0)
+		{
+			kthread_set_errno(kthread, EXIT_SUCCESS);
+			kthread_set_syscall_retval(kthread, retval);
+		}
+		else {
+			kthread_set_errno(kthread, -retval);
+			kthread_set_syscall_retval(kthread, EXIT_FAILURE);
+		}
+
+		kthread_move_to_ready(kthread, LAST);
+		released++;
+	}
+
+	return released;
+}
+
+/*!
+ * Release all threads blocked on device (in read, write or poll), since
+ * device is removed
+ * \param kdev Device
+ * \param errno Error number to set for released threads
+ */
+static void kdevice_release_all(kdevice_t *kdev, int errno)
+{
+	kthread_t *kthread;
+	kdevice_poll_t *pwait;
+
+	while ((kthread = kthreadq_remove(&kdev->readq, NULL)) ||
+		(kthread = kthreadq_remove(&kdev->writeq, NULL)))
+	{
+		kthread_set_errno(kthread, errno);
+		kthread_set_syscall_retval(kthread, EXIT_FAILURE);
+		kthread_move_to_ready(kthread, LAST);
+	}
+
+	while ((pwait = list_get(&kdev->pollers, FIRST)))
+	{
+		kthread = pwait->kpoll->kthread;
+
+		kthread_set_errno(kthread, errno);
+		kthread_set_syscall_retval(kthread, EXIT_FAILURE);
+		kthread_move_to_ready(kthread, LAST);
+
+		/* removes all its elements from device lists */
+		kdevice_poll_release(pwait->kpoll);
+	}
 }
 
 int kdevice_status(descriptor_t *desc, int flags, kprocess_t *proc)
@@ -432,12 +748,106 @@ int sys__device_status(void *p)
 		EXIT2(EXIT_SUCCESS, status);
 }
 
+/*! Check all descriptors in poll request and set 'revents' for them */
+static int kdevice_poll_check(kpoll_t *kpoll, kprocess_t *proc)
+{
+	int changes = 0, i;
+	short revents;
+
+	for (i = 0; i < kpoll->nfds; i++)
+	{
+		revents = kdevice_status(&kpoll->std_desc[kpoll->fds[i].fd],
+					 kpoll->fds[i].events, proc);
+		if (revents == -1)
+			return -1;
+
+		kpoll->fds[i].revents = revents;
+		if (revents)
+			changes++;
+	}
+
+	return changes;
+}
+
+/*! Remove blocked thread from device lists and free poll request */
+static void kdevice_poll_release(kpoll_t *kpoll)
+{
+	int i;
+
+	for (i = 0; i < kpoll->nfds; i++)
+		if (kpoll->wait[i].kdev)
+			list_remove(&kpoll->wait[i].kdev->pollers, 0,
+				      &kpoll->wait[i].list);
+
+	if (kpoll->ktimer)
+		ktimer_delete(kpoll->ktimer);
+
+	kfree(kpoll);
+}
+
+/*! Timeout expired for thread blocked in poll */
+static void kdevice_poll_timeout(sigval_t sigval)
+{
+	kpoll_t *kpoll = sigval.sival_ptr;
+	kthread_t *kthread = kpoll->kthread;
+	void *func, *param;
+	int changes;
+	timespec_t now;
+
+	if (k_id_object(kpoll->tid, KTYPE_THREAD) == kthread &&
+		kthread_is_suspended(kthread, &func, &param) &&
+		func == kdevice_poll_interrupt && param == kpoll)
+	{
+		/* devices that don't report changes are checked only here */
+		changes = kdevice_poll_check(kpoll,
+					     kthread_get_process(kthread));
+
+		if (changes == 0 && kpoll->recheck)
+		{
+			/* periodic check: keep waiting until deadline */
+			if (!TIME_IS_SET(&kpoll->deadline))
+				return;
+
+			kclock_gettime(CLOCK_REALTIME, &now);
+			if (time_cmp(&now, &kpoll->deadline) < 0)
+				return;
+		}
+
+		if (changes >= 0)
+		{
+			kthread_set_errno(kthread, EXIT_SUCCESS);
+			kthread_set_syscall_retval(kthread, changes);
+		}
+		else {
+			kthread_set_errno(kthread, EINVAL);
+			kthread_set_syscall_retval(kthread, EXIT_FAILURE);
+		}
+
+		kthread_move_to_ready(kthread, LAST);
+
+		kdevice_poll_release(kpoll);
+	}
+
+	kthreads_schedule();
+}
+
+/*! Poll interrupted by signal or thread is canceled */
+static void kdevice_poll_interrupt(kthread_t *kthread, void *param)
+{
+	ASSERT(kthread && param);
+
+	kdevice_poll_release(param);
+
+	kthread_set_syscall_retval(kthread, EXIT_FAILURE);
+	kthread_set_errno(kthread, EINTR);
+}
+
 /*!
  * poll - input/output multiplexing
  * \param fds set of file descriptors
  * \param nfds number of file descriptors in fds
  * \param timeout minimum time in ms to wait for any event defined by fds
- *       (in current implementation this parameter is ignored)
+ *       (0 - return immediately, -1 - wait until event occurs)
  * \param std_desc address of file descriptor array from user space
  * \return number of file descriptors with changes in revents, -1 on errors
  */
@@ -445,12 +855,16 @@ int sys__poll(void *p)
 {
 	struct pollfd *fds;
 	nfds_t nfds;
-	int timeout __attribute__((unused));
+	int timeout;
 	descriptor_t *std_desc;
 
-	int changes = 0, i;
-	short revents;
+	int changes, i;
 	kprocess_t *proc;
+	kthread_t *kthread;
+	kobject_t *kobj;
+	kpoll_t *kpoll, kpoll_now;
+	sigevent_t evp;
+	itimerspec_t itimer;
 
 	fds =       *((struct pollfd **) p);	p += sizeof(struct pollfd *);
 	nfds =      *((nfds_t *) p);		p += sizeof(nfds_t);
@@ -458,24 +872,92 @@ int sys__poll(void *p)
 	std_desc =  *((descriptor_t **) p);
 
 	proc = kthread_get_process(NULL);
+	kthread = kthread_get_active();
 
 	ASSERT_ERRNO_AND_EXIT(fds && nfds > 0 && std_desc, EINVAL);
 	fds = U2K_GET_ADR(fds, proc);
 	ASSERT_ERRNO_AND_EXIT(fds, EINVAL);
+	if (k_memory_commit(proc, fds, nfds * sizeof(struct pollfd)))
+		EXIT(ENOMEM);
 	std_desc = U2K_GET_ADR(std_desc, proc);
 	ASSERT_ERRNO_AND_EXIT(std_desc, EINVAL);
 
+	kpoll_now.fds = fds;
+	kpoll_now.nfds = nfds;
+	kpoll_now.std_desc = std_desc;
+
+	changes = kdevice_poll_check(&kpoll_now, proc);
+	ASSERT_ERRNO_AND_EXIT(changes != -1, EINVAL);
+
+	if (changes || timeout == 0)
+		EXIT2(EXIT_SUCCESS, changes);
+
+	/* nothing ready - block thread until device event or timeout */
+	kpoll = kmalloc(sizeof(kpoll_t) + (nfds - 1) * sizeof(kdevice_poll_t));
+	if (!kpoll)
+		EXIT(ENOMEM);
+
+	*kpoll = kpoll_now;
+	kpoll->kthread = kthread;
+	kpoll->tid = kthread_get_id(kthread);
+	kpoll->ktimer = NULL;
+	kpoll->recheck = FALSE;
+	TIME_RESET(&kpoll->deadline);
+
+	/* add thread to "pollers" list of each polled device */
 	for (i = 0; i < nfds; i++)
 	{
-		revents = kdevice_status(
-			&std_desc[fds[i].fd], fds[i].events, proc
-		);
-		ASSERT_ERRNO_AND_EXIT(revents != -1, EINVAL);
+		kobj = std_desc[fds[i].fd].ptr;
+		kpoll->wait[i].kpoll = kpoll;
+		kpoll->wait[i].kdev = kobj->kobject;
+		list_append(&kpoll->wait[i].kdev->pollers, &kpoll->wait[i],
+			      &kpoll->wait[i].list);
+
+		/* devices that don't report changes must be checked */
+		if (!k_device_notifies(kpoll->wait[i].kdev))
+			kpoll->recheck = TRUE;
+	}
 
-		fds[i].revents = revents;
-		if (revents)
-			changes++;
+	if (timeout > 0 || kpoll->recheck)
+	{
+		evp.sigev_notify = SIGEV_WAKE_THREAD;
+		evp.sigev_value.sival_ptr = kpoll;
+		evp.sigev_notify_function = kdevice_poll_timeout;
+
+		if (ktimer_create(CLOCK_REALTIME, &evp, &kpoll->ktimer,
+				    kthread))
+		{
+			kdevice_poll_release(kpoll);
+			EXIT(ENOMEM);
+		}
+
+		TIME_RESET(&itimer.it_interval);
+		itimer.it_value.tv_sec = timeout / 1000;
+		itimer.it_value.tv_nsec = (timeout % 1000) * 1000000L;
+
+		if (kpoll->recheck)
+		{
+			if (timeout > 0)
+			{
+				kclock_gettime(CLOCK_REALTIME,
+						 &kpoll->deadline);
+				time_add(&kpoll->deadline, &itimer.it_value);
+			}
+
+			itimer.it_interval.tv_sec = 0;
+			itimer.it_interval.tv_nsec = POLL_RECHECK * 1000000L;
+			if (timeout < 0 || timeout > POLL_RECHECK)
+				itimer.it_value = itimer.it_interval;
+		}
+
+		ktimer_settime(kpoll->ktimer, 0, &itimer, NULL);
 	}
 
-	EXIT2(EXIT_SUCCESS, changes);
+	kthread_suspend(kthread, kdevice_poll_interrupt, kpoll);
+
+	/* return values are set again when thread is released */
+	SET_ERRNO(EXIT_SUCCESS);
+	kthreads_schedule();
+
+	return 0;
 }
@@ -2,6 +2,7 @@
 #pragma once
 
 #include <kernel/device.h>
+#include <kernel/memory.h>
 #include <arch/device.h>
 
 #ifndef _K_DEVICE_C_
@@ -13,6 +14,7 @@ typedef void kdevice_t;
 
 #include <lib/list.h>
 #include "thread.h"
+#include "time.h"
 
 /*! Kernel device object */
 typedef struct _kdevice_t_
@@ -34,9 +36,63 @@ typedef struct _kdevice_t_
 
 	list_t	   descriptors;
 		   /* list of all descriptor referencing this list */
+
+	int	   notify;
+		   /* device reports changes: its interrupt is enabled
+		    * (or it is kernel object) */
+
+	list_t	   pollers;
+		   /* threads blocked in poll on this device (kdevice_poll_t) */
+
+	kthread_q  readq;
+		   /* threads blocked in read, waiting for data */
+
+	kthread_q  writeq;
+		   /* threads blocked in write, waiting for space in buffer */
 }
 kdevice_t;
 
+struct _kpoll_t_;
+
+/*! Thread blocked in poll - one element for each polled descriptor */
+typedef struct _kdevice_poll_t_
+{
+	struct _kpoll_t_  *kpoll;
+			   /* poll request this element belongs to */
+
+	kdevice_t	  *kdev;
+			   /* polled device */
+
+	list_h		   list;
+			   /* element in device "pollers" list */
+}
+kdevice_poll_t;
+
+/*! Poll request of blocked thread */
+typedef struct _kpoll_t_
+{
+	kthread_t	*kthread;
+	id_t		 tid;
+			 /* blocked thread (descriptor may be reused; check id) */
+
+	struct pollfd	*fds;
+	nfds_t		 nfds;
+	descriptor_t	*std_desc;
+			 /* poll arguments (already in kernel addresses) */
+
+	ktimer_t	*ktimer;
+			 /* timeout timer (NULL if waiting without timeout) */
+
+	int		 recheck;
+	timespec_t	 deadline;
+			 /* timer is periodic: some devices don't report
+			  * changes; deadline is not set for infinite wait */
+
+	kdevice_poll_t	 wait[1];
+			 /* one element per descriptor (variable length) */
+}
+kpoll_t;
+
 #endif /* _K_DEVICE_C_ */
 
 /*! kernel interface */
@@ -46,11 +102,18 @@ kdevice_t *k_device_add(device_t *kdev);
 int k_device_init(kdevice_t *kdev, int flags, void *params, void *callback);
 int k_device_remove(kdevice_t *kdev);
 
+kdevice_t *k_device_create(device_t *dev, void *params);
+void k_device_notify(kdevice_t *kdev);
+
 kdevice_t *k_device_open(char *name, int flags);
 void k_device_close(kdevice_t *kdev);
+kobject_t *k_device_descriptor(kdevice_t *kdev, int flags, descriptor_t *desc,
+				 kprocess_t *proc);
 
 int k_device_send(void *data, size_t size, int flags, kdevice_t *kdev);
 int k_device_recv(void *data, size_t size, int flags, kdevice_t *kdev);
+int k_device_notifies(kdevice_t *kdev);
+int k_device_info();
 
 int k_device_lock(kdevice_t *dev, int wait);
 int k_device_unlock(kdevice_t *dev);
@@ -0,0 +1,76 @@
+/*! Interrupt handling - kernel part: interrupt statistics */
+#define _K_INTERRUPT_C_
+
+#include "interrupt.h"
+
+#include <kernel/errno.h>
+#include <arch/interrupt.h>
+#include <arch/time.h>
+
+/*
+ * Kernel is not reentrant (interrupt stack is reset on every entry), so
+ * interrupt handlers and all kernel work they start (releasing threads,
+ * activating timers) are done with interrupts disabled. Statistics show
+ * how long that takes for each interrupt: the longest duration is the
+ * worst case delay for other interrupts.
+ */
+
+/*! statistics for each interrupt */
+static kinterrupt_stat_t istat[INTERRUPTS];
+
+/*! Initialize statistics */
+void k_interrupts_init()
+{
+	int i;
+
+	for (i = 0; i < INTERRUPTS; i++)
+	{
+		istat[i].count = 0;
+		TIME_RESET(&istat[i].max);
+	}
+
+	arch_register_interrupt_exit_handler(k_interrupt_exit);
+}
+
+/*! Time in microseconds (for printing) */
+static int k_interrupt_us(timespec_t *t)
+{
+	return t->tv_sec * 1000000 + t->tv_nsec / 1000;
+}
+
+/*!
+ * Exit from interrupt (called from arch layer, after interrupt handlers and
+ * after interrupt controller is acknowledged) - update statistics
+ * \param irq_num Interrupt number
+ * \param entry Time when interrupt processing started
+ */
+void k_interrupt_exit(int irq_num, timespec_t *entry)
+{
+	timespec_t t;
+
+	if (irq_num < 0 || irq_num >= INTERRUPTS)
+		return;
+
+	arch_get_time(&t);
+	time_sub(&t, entry);
+
+	istat[irq_num].count++;
+	if (time_cmp(&t, &istat[irq_num].max) > 0)
+		istat[irq_num].max = t;
+}
+
+/*! Print interrupt statistics */
+int k_interrupt_info()
+{
+	int i;
+
+	kprintf("Interrupts info (max. duration of processing, with "
+		"interrupts disabled, in microseconds)\n");
+
+	for (i = 0; i < INTERRUPTS; i++)
+		if (istat[i].count)
+			kprintf("[%d]\tcount=%d\tmax=%d\n", i, istat[i].count,
+				 k_interrupt_us(&istat[i].max));
+
+	return 0;
+}
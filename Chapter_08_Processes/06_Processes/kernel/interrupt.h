@@ -0,0 +1,23 @@
+/*! Interrupt handling - kernel part: interrupt statistics */
+#pragma once
+
+#include <types/time.h>
+
+void k_interrupts_init();
+void k_interrupt_exit(int irq_num, timespec_t *entry);
+int k_interrupt_info();
+
+#ifdef _K_INTERRUPT_C_
+
+/*! Interrupt statistics */
+typedef struct _kinterrupt_stat_t_
+{
+	uint	count;
+		/* number of interrupts */
+
+	timespec_t max;
+		/* longest time from entry to exit from interrupt */
+}
+kinterrupt_stat_t;
+
+#endif /* _K_INTERRUPT_C_ */
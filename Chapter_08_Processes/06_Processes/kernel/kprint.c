@@ -4,22 +4,244 @@
 #include <kernel/kprint.h> /* shares kprint with arch layer */
 
 #include "device.h"
+#include "time.h"
 #include <lib/string.h>
 
 void *k_stdout; /* initialized in startup.c */
 
+/*
+ * Kernel messages are not printed immediately (printing on slow devices as
+ * UART would delay code that prints - including interrupt handlers).
+ * Messages are stored in circular buffer, and printed later:
+ * - when there is nothing else to do (idle thread is scheduled)
+ * - when output device signals it can accept more data
+ * - synchronously with kprint_flush (before halting the system)
+ * Kernel functions are executed with interrupts disabled, so 'msg_last' is
+ * changed only by writer (klog) and 'msg_first' only by reader (kprint_next).
+ */
+
+/*! Header of each message in buffer (message text follows header) */
+typedef struct _kprint_msg_t_
+{
+	timespec_t time;
+		   /* when message was created */
+
+	int	   level;
+		   /* log level (KLOG_*) */
+
+	int	   size;
+		   /* message length (without terminating '\0') */
+}
+kprint_msg_t;
+
+/*! circular buffer for messages */
+static char msg_buffer[KPRINT_BUFFER_SIZE];
+static uint msg_first = 0, msg_last = 0; /* not wrapped (use % SIZE) */
+static uint msg_lost = 0; /* messages dropped since buffer was full */
+
+/*! messages with levels above this are ignored */
+static int log_level = KLOG_DEBUG;
+
+/*! message being printed (formated, with colors and timestamp) */
+static char out_buffer[CONSOLE_MAXLEN + 32];
+static int out_size = 0, out_sent = 0;
+
+/*! how many times to retry sending on busy device (flush, or no callback) */
+#define FLUSH_RETRY	1000000
+
+static int kprint_add(int level, char **format);
+static void kprint_put(void *data, size_t size);
+static void kprint_get(void *data, size_t size);
+static int kprint_next();
+
 /*! Formated output to console (lightweight version of 'printf') */
 int kprintf(char *format, ...)
 {
-	size_t size;
+	return kprint_add(KLOG_PRINT, &format);
+}
+
+/*!
+ * Formated output to console, for given log level
+ * \param level Log level (KLOG_*)
+ * \param format Format string (as for kprintf)
+ * \return number of characters saved for printing, 0 if message is ignored
+ */
+int klog(int level, char *format, ...)
+{
+	return kprint_add(level, &format);
+}
+
+/*!
+ * Set log level - messages with higher levels (less important) are ignored
+ * \param level New log level (KLOG_BUG - KLOG_DEBUG)
+ * \return previous log level
+ */
+int klog_set_level(int level)
+{
+	int old_level = log_level;
+
+	if (level >= KLOG_BUG && level <= KLOG_DEBUG)
+		log_level = level;
+
+	return old_level;
+}
+
+/*! Format message and save it into buffer */
+static int kprint_add(int level, char **format)
+{
 	char buffer[CONSOLE_MAXLEN];
+	kprint_msg_t msg;
+
+	if (level != KLOG_PRINT && level > log_level)
+		return 0;
+
+	msg.size = vssprintf(buffer, CONSOLE_MAXLEN, format) - 1;
+	if (msg.size <= 0)
+		return 0;
+
+	if (msg_last - msg_first + sizeof(kprint_msg_t) + msg.size >
+		KPRINT_BUFFER_SIZE)
+	{
+		msg_lost++;
+		return 0;
+	}
 
-	k_device_send("\x1b[31m", 6, 0, k_stdout); /* red color for text */
+	msg.level = level;
+	kclock_gettime(CLOCK_REALTIME, &msg.time);
+
+	kprint_put(&msg, sizeof(kprint_msg_t));
+	kprint_put(buffer, msg.size);
+
+	return msg.size;
+}
 
-	size = vssprintf(buffer, CONSOLE_MAXLEN, &format);
-	k_device_send(buffer, size, 0, k_stdout);
+/*! Copy data to buffer (at msg_last) */
+static void kprint_put(void *data, size_t size)
+{
+	char *d = data;
+
+	while (size-- > 0)
+		msg_buffer[msg_last++ % KPRINT_BUFFER_SIZE] = *d++;
+}
+
+/*! Copy data from buffer (from msg_first) */
+static void kprint_get(void *data, size_t size)
+{
+	char *d = data;
+
+	while (size-- > 0)
+		*d++ = msg_buffer[msg_first++ % KPRINT_BUFFER_SIZE];
+}
+
+/*! Prepare next message from buffer in 'out_buffer' */
+static int kprint_next()
+{
+	kprint_msg_t msg;
+	char *p;
+	int ms;
+
+	out_size = out_sent = 0;
+	p = out_buffer;
+
+	strcpy(p, "\x1b[31m"); /* red color for text */
+	p += strlen(p);
+
+	if (msg_lost)
+	{
+		*p++ = '[';
+		itoa(p, 'd', msg_lost);
+		p += strlen(p);
+		strcpy(p, " messages lost]\n");
+		p += strlen(p);
+		msg_lost = 0;
+	}
+	else if (msg_first != msg_last)
+	{
+		kprint_get(&msg, sizeof(kprint_msg_t));
+
+		if (msg.level != KLOG_PRINT)
+		{
+			/* timestamp: [seconds.milliseconds] */
+			ms = msg.time.tv_nsec / 1000000;
+			*p++ = '[';
+			itoa(p, 'd', msg.time.tv_sec);
+			p += strlen(p);
+			*p++ = '.';
+			*p++ = '0' + ms / 100;
+			*p++ = '0' + ms / 10 % 10;
+			*p++ = '0' + ms % 10;
+			*p++ = ']';
+			*p++ = ' ';
+		}
+
+		kprint_get(p, msg.size);
+		p += msg.size;
+	}
+	else {
+		return FALSE;
+	}
+
+	strcpy(p, "\x1b[39m"); /* default color for text */
+	p += strlen(p);
+
+	out_size = p - out_buffer;
+
+	return TRUE;
+}
+
+/*!
+ * Print messages from buffer, as long as output device accepts them
+ * (called when idle thread is scheduled and from device callback)
+ */
+void kprint_drain()
+{
+	static int active = FALSE;
+	int sent, retry = FLUSH_RETRY;
+
+	if (active || !k_stdout)
+		return; /* already printing (called from device driver) */
+
+	active = TRUE;
+
+	while (retry > 0 && (out_sent < out_size || kprint_next()))
+	{
+		sent = k_device_send(&out_buffer[out_sent], out_size - out_sent,
+				       0, k_stdout);
+		if (sent > 0)
+		{
+			out_sent += sent;
+			retry = FLUSH_RETRY;
+		}
+		else if (k_device_notifies(k_stdout)) {
+			break; /* device is busy; continue from its callback */
+		}
+		else {
+			retry--; /* no callback will come; poll device */
+		}
+	}
+
+	active = FALSE;
+}
+
+/*! Print all messages from buffer before returning (e.g. before halt) */
+void kprint_flush()
+{
+	int sent, retry = FLUSH_RETRY;
 
-	k_device_send("\x1b[39m", 6, 0, k_stdout); /* default color for text */
+	if (!k_stdout)
+		return;
 
-	return size;
+	while (retry > 0 && (out_sent < out_size || kprint_next()))
+	{
+		sent = k_device_send(&out_buffer[out_sent], out_size - out_sent,
+				       0, k_stdout);
+		if (sent > 0)
+		{
+			out_sent += sent;
+			retry = FLUSH_RETRY;
+		}
+		else {
+			retry--; /* device buffer is full, wait */
+		}
+	}
 }
@@ -5,9 +5,13 @@
 
 #include <kernel/kprint.h>
 #include "thread.h"
+#include "interrupt.h"
+#include "device.h"
 #include <kernel/errno.h>
 #include <arch/processor.h>
 #include <arch/interrupt.h>
+#include <arch/paging.h>
+#include <arch/time.h>
 #include <lib/string.h>
 #include <lib/list.h>
 #include <types/bits.h>
@@ -18,14 +22,36 @@ MEM_ALLOC_T *k_mpool = NULL;
 /*! Memory segments */
 static mseg_t *mseg = NULL;
 
+#define PAGE_ALIGN_DOWN(ADR)	((void *) ((aint) (ADR) & ~(PAGE_SIZE - 1)))
+#define PAGE_ALIGN_UP(ADR)	PAGE_ALIGN_DOWN((aint) (ADR) + PAGE_SIZE - 1)
+
 /*! List of programs */
 list_t kprogs;
 
+/*! Programs indexed by name */
+#define PROG_HASH_SIZE	32
+static kprog_t *prog_hash[PROG_HASH_SIZE];
+static uint k_prog_hash(char *name);
+static void k_add_program(kprog_t *kprog);
+static kprog_t *k_module_program(mseg_t *m);
+static kprog_t *k_elf_program(void *image, size_t size);
+static void k_program_layout(kprog_t *kprog);
+static int kprocess_memory_map(kprocess_t *kproc, kprog_t *kprog,
+				 int reset);
+static int k_drop_warm_process();
+
+static void k_frames_init(void *start, void *end);
+static void k_ids_init();
+static void kprocess_memory_release(kprocess_t *kproc, void *start,
+				      void *end);
+
 /*! Initial memory layout created in arch layer */
 void k_memory_init()
 {
 	int i;
 	kprog_t *kprog;
+	ramdisk_file_t *file;
+	size_t heap_size;
 
 	k_mpool = NULL;
 	mseg = arch_memory_init();
@@ -35,30 +61,295 @@ void k_memory_init()
 	{
 		if (mseg[i].type == MS_KHEAP)
 		{
-			k_mpool = k_mem_init(mseg[i].start, mseg[i].size);
+			/* kernel heap first, rest is used for page frames */
+			heap_size = KERNEL_HEAP_SIZE;
+			if (heap_size > mseg[i].size / 2)
+				heap_size = mseg[i].size / 2;
+
+			k_mpool = k_mem_init(mseg[i].start, heap_size);
+			k_frames_init(mseg[i].start + heap_size,
+				       mseg[i].start + mseg[i].size);
 			break;
 		}
 	}
 
 	ASSERT(k_mpool);
 
+	k_ids_init();
+
+	/* kernel uses physical addresses; processes get own page tables */
+	arch_paging_init(k_frame_alloc, mseg[i].start + mseg[i].size);
+
 	list_init(&kprogs);
+	memset(prog_hash, 0, sizeof(prog_hash));
 
-	/* look into each segment marked as program and add it to 'progs' */
+	/* programs: modules with single program and ramdisks with ELF files */
 	for (i = 0; mseg[i].type != MS_END; i++)
 	{
-		if (mseg[i].type != MS_PROGRAM)
+		if (mseg[i].type == MS_PROGRAM)
+		{
+			kprog = k_module_program(&mseg[i]);
+			k_add_program(kprog);
+		}
+		else if (mseg[i].type == MS_RAMDISK)
+		{
+			file = mseg[i].start + sizeof(module_t);
+			for (; file->size; file++)
+			{
+				kprog = k_elf_program(mseg[i].start +
+							file->offset,
+							file->size);
+				if (kprog)
+					k_add_program(kprog);
+				else
+					LOG(WARN, "Invalid program in ramdisk "
+						  "(offset %x)!\n",
+						  file->offset);
+			}
+		}
+	}
+}
+
+/*! Add program to list of programs and index */
+static void k_add_program(kprog_t *kprog)
+{
+	uint h;
+
+	list_init(&kprog->warm);
+	kprog->warm_count = 0;
+
+	list_append(&kprogs, kprog, &kprog->list);
+
+	h = k_prog_hash(kprog->prog->name);
+	kprog->hash_next = prog_hash[h];
+	prog_hash[h] = kprog;
+}
+
+/*! Describe program loaded as module (image is program memory layout) */
+static kprog_t *k_module_program(mseg_t *m)
+{
+	kprog_t *kprog;
+
+	kprog = kmalloc(sizeof(kprog_t));
+	ASSERT(kprog);
+
+	kprog->prog = &((module_program_t *) m->start)->prog;
+	kprog->size = (size_t) PAGE_ALIGN_UP(m->size);
+	kprog->base = 0;
+	kprog->rel = NULL;
+	kprog->relnum = 0;
+
+	kprog->segs = 1;
+	kprog->seg[0].vaddr = 0;
+	kprog->seg[0].data = m->start;
+	kprog->seg[0].filesz = m->size;
+	kprog->seg[0].memsz = m->size;
+
+	k_program_layout(kprog);
+
+	return kprog;
+}
+
+/*!
+ * Describe program from ELF file: PT_LOAD segments are mapped into process
+ * (.bss is not in file, its zero filled when used); program header
+ * (program_t) must be at the start of the lowest segment. Image linked at
+ * address other than 0 must have only relative relocations (ELF_R_RELATIVE),
+ * which are applied when program is loaded (processes use addresses
+ * relative to process start).
+ * \param image ELF file
+ * \param size File size
+ * \return program descriptor, NULL if file is not usable
+ */
+static kprog_t *k_elf_program(void *image, size_t size)
+{
+	elf32_ehdr_t *eh = image;
+	elf32_phdr_t *ph;
+	elf32_dyn_t *dyn = NULL;
+	kprog_t *kprog;
+	kprog_seg_t *seg;
+	size_t base = (size_t) -1, end = 0, rel = 0, relsz = 0;
+	size_t relent = sizeof(elf32_rel_t);
+	uint i, j;
+
+	if (size < sizeof(elf32_ehdr_t) ||
+		eh->e_ident[0] != ELFMAG0 || eh->e_ident[1] != ELFMAG1 ||
+		eh->e_ident[2] != ELFMAG2 || eh->e_ident[3] != ELFMAG3 ||
+		eh->e_ident[EI_CLASS] != ELFCLASS32 ||
+		eh->e_ident[EI_DATA] != ELFDATA2LSB ||
+		eh->e_machine != ELF_MACHINE ||
+		(eh->e_type != ET_EXEC && eh->e_type != ET_DYN) ||
+		eh->e_phentsize != sizeof(elf32_phdr_t) ||
+		eh->e_phoff + eh->e_phnum * sizeof(elf32_phdr_t) > size)
+		return NULL;
+
+	kprog = kmalloc(sizeof(kprog_t));
+	ASSERT(kprog);
+	kprog->segs = 0;
+	kprog->rel = NULL;
+	kprog->relnum = 0;
+
+	ph = image + eh->e_phoff;
+	for (i = 0; i < eh->e_phnum; i++, ph++)
+	{
+		if (ph->p_type == PT_DYNAMIC && ph->p_offset < size)
+			dyn = image + ph->p_offset;
+
+		if (ph->p_type != PT_LOAD || !ph->p_memsz)
 			continue;
 
-		kprog = kmalloc(sizeof(kprog_t));
+		if (kprog->segs == KPROG_SEGS ||
+			ph->p_offset + ph->p_filesz > size ||
+			ph->p_filesz > ph->p_memsz)
+			goto invalid;
+
+		seg = &kprog->seg[kprog->segs++];
+		seg->vaddr = ph->p_vaddr;
+		seg->data = image + ph->p_offset;
+		seg->filesz = ph->p_filesz;
+		seg->memsz = ph->p_memsz;
+
+		if (ph->p_vaddr < base)
+			base = ph->p_vaddr;
+		if (ph->p_vaddr + ph->p_memsz > end)
+			end = ph->p_vaddr + ph->p_memsz;
+	}
+	if (!kprog->segs)
+		goto invalid;
+
+	base = (size_t) PAGE_ALIGN_DOWN(base);
+	kprog->base = base;
+	kprog->size = (size_t) PAGE_ALIGN_UP(end - base);
+
+	/* addresses relative to program start; header is at start */
+	kprog->prog = NULL;
+	for (i = 0; i < kprog->segs; i++)
+	{
+		seg = &kprog->seg[i];
+		seg->vaddr -= base;
+		if (seg->vaddr == 0 && seg->filesz >= sizeof(program_t))
+			kprog->prog = seg->data;
+	}
+	if (!kprog->prog ||
+		kprog->prog->magic[0] != PMAGIC1 ||
+		kprog->prog->magic[1] != ~PMAGIC1 ||
+		kprog->prog->magic[2] != PMAGIC2 ||
+		kprog->prog->magic[3] != ~PMAGIC2 ||
+		kprog->prog->type != MS_PROGRAM)
+		goto invalid;
+
+	/* relative relocations (from dynamic section) */
+	for (; dyn && dyn->d_tag != DT_NULL &&
+		(void *) (dyn + 1) <= image + size; dyn++)
+	{
+		if (dyn->d_tag == DT_REL)
+			rel = dyn->d_val - base;
+		else if (dyn->d_tag == DT_RELSZ)
+			relsz = dyn->d_val;
+		else if (dyn->d_tag == DT_RELENT)
+			relent = dyn->d_val;
+	}
+	if (relsz)
+	{
+		if (relent != sizeof(elf32_rel_t))
+			goto invalid;
+
+		for (i = 0; i < kprog->segs; i++)
+		{
+			seg = &kprog->seg[i];
+			if (rel >= seg->vaddr &&
+				rel + relsz <= seg->vaddr + seg->filesz)
+				kprog->rel = seg->data + rel - seg->vaddr;
+		}
+		if (!kprog->rel)
+			goto invalid;
+
+		kprog->relnum = relsz / sizeof(elf32_rel_t);
+		for (j = 0; j < kprog->relnum; j++)
+		{
+			if (ELF32_R_TYPE(kprog->rel[j].r_info) != ELF_R_NONE &&
+			    ELF32_R_TYPE(kprog->rel[j].r_info) != ELF_R_RELATIVE)
+				goto invalid; /* needs symbols; not supported */
+		}
+	}
 
-		kprog->m = &mseg[i];
-		kprog->prog = &((module_program_t *) mseg[i].start)->prog;
+	k_program_layout(kprog);
 
-		list_append(&kprogs, kprog, &kprog->list);
+	return kprog;
+
+invalid:
+	kfree(kprog);
+	return NULL;
+}
+
+/*!
+ * Find part of program that can be shared between processes: [text, data)
+ * read only part, [data, ...) copy on write; relocations prevent sharing
+ */
+static void k_program_layout(kprog_t *kprog)
+{
+	uint i;
+	size_t offset;
+
+	kprog->text = (size_t) kprog->prog->text - kprog->base;
+	kprog->data = (size_t) kprog->prog->data - kprog->base;
+
+	if (((kprog->text | kprog->data) & (PAGE_SIZE - 1)) ||
+		!kprog->text || kprog->text > kprog->data ||
+		kprog->data > kprog->size)
+		kprog->text = kprog->data = kprog->size; /* copy all */
+
+	for (i = 0; kprog->base && i < kprog->relnum; i++)
+	{
+		offset = kprog->rel[i].r_offset - kprog->base;
+		if (offset < kprog->data)
+			kprog->text = kprog->data = kprog->size;
 	}
 }
 
+/*! Hash of program name */
+static uint k_prog_hash(char *name)
+{
+	uint h = 5381;
+
+	while (*name)
+		h = h * 33 + *name++;
+
+	return h % PROG_HASH_SIZE;
+}
+
+/*! Free one cached address space (when short of page frames) */
+static int k_drop_warm_process()
+{
+	kprog_t *kprog;
+	kprocess_t *kproc;
+
+	kprog = list_get(&kprogs, FIRST);
+	while (kprog && !kprog->warm_count)
+		kprog = list_get_next(&kprog->list);
+
+	if (!kprog)
+		return FALSE;
+
+	kproc = list_remove(&kprog->warm, FIRST, NULL);
+	kprog->warm_count--;
+	kprocess_memory_free(kproc);
+	kfree(kproc);
+
+	return TRUE;
+}
+
+/*! Find program by name (NULL if there is no such program) */
+kprog_t *k_find_program(char *name)
+{
+	kprog_t *kprog = prog_hash[k_prog_hash(name)];
+
+	while (kprog && strcmp(kprog->prog->name, name))
+		kprog = kprog->hash_next;
+
+	return kprog;
+}
+
 void *k_mem_init(void *segment, size_t size)
 {
 	return K_MEM_INIT(segment, size);
@@ -85,9 +376,18 @@ size_t k_process_size(void *proc)
 /*! kernel <--> user address translation (using segmentation) */
 void *k_u2k_adr(void *uadr, kprocess_t *proc)
 {
+	void *kadr;
+
 	ASSERT((aint) uadr < proc->m.size);
 
-	return uadr + (aint) proc->m.start;
+	kadr = uadr + (aint) proc->m.start;
+
+	/* kernel must not cause page faults - make page(s) it will read
+	 * present (objects given to kernel are smaller than a page); objects
+	 * and buffers kernel writes to are committed by system calls */
+	(void) k_memory_present(proc, kadr, PAGE_SIZE);
+
+	return kadr;
 }
 void *k_k2u_adr(void *kadr, kprocess_t *proc)
 {
@@ -150,52 +450,102 @@ int kfree_process_kobjects(kprocess_t *proc)
 }
 
 
-/*! unique system wide id numbers */
+/*! unique system wide id numbers and id -> object registry */
 #define	WBITS		(sizeof(word_t) * 8)
 #define	ID_ELEMS	((MAX_RESOURCES-1) / WBITS + 1)
 #define MAX_RES		(ID_ELEMS * WBITS)
+#define SUM_ELEMS	((ID_ELEMS-1) / WBITS + 1)
 
-static word_t idmask[ ID_ELEMS ] = {0};
+/*
+ * Two level bitmap of free ids: bit in 'idfree[e]' is set for free id,
+ * bit 'e' in 'idsum' is set when 'idfree[e]' has at least one free id.
+ * Free id is found with two 'lsb_index' operations (for up to WBITS*WBITS
+ * ids in single 'idsum' element).
+ */
+static word_t idfree[ ID_ELEMS ];
+static word_t idsum[ SUM_ELEMS ];
 static id_t last_id = 0;
 
-/*! Allocate and return unique id for new system resource */
-id_t k_new_id()
+/*! registered objects, indexed by id */
+static struct {
+	void	*object;
+	int	 type;
+}
+idobj[ MAX_RES ];
+
+/*! Mark all ids as free (except 0) */
+static void k_ids_init()
 {
-	id_t id = -1;
-	uint elem, n, start;
+	uint i;
+
+	for (i = 0; i < ID_ELEMS; i++)
+	{
+		idfree[i] = ~((word_t) 0);
+		idsum[i / WBITS] |= ((word_t) 1) << (i % WBITS);
+	}
+	idfree[0] &= ~((word_t) 1); /* skip 0 */
+
+	memset(idobj, 0, sizeof(idobj));
+	last_id = 0;
+}
+
+/*! Find first free id that is not smaller than 'from'; -1 if none */
+static id_t k_find_free_id(uint from)
+{
+	uint elem, s;
 	word_t mask;
 
-	last_id++;
-	if (last_id == MAX_RES)
-		last_id = 1; /* skip 0 */
+	elem = from / WBITS;
+	if (elem >= ID_ELEMS)
+		return -1;
 
-	elem = last_id / WBITS;
-	mask = idmask [elem] |((1 << (last_id % WBITS)) - 1);
-	/* do not look at lower bits (for now) */
+	mask = idfree[elem] & (~((word_t) 0) << (from % WBITS));
+	if (mask)
+		return elem * WBITS + lsb_index(mask);
 
-	if (~mask) /* current 'elem' has free ids from last_id forward */
+	/* first next element with free ids */
+	elem++;
+	for (s = elem / WBITS; s < SUM_ELEMS; s++)
 	{
-		id = lsb_index(~mask);
-		ASSERT(id != -1);
-	}
-	else {
-		n = start = (elem + 1) % ID_ELEMS;
-		do {
-			if (~idmask[n])
-			{
-				id = lsb_index(~idmask[n]);
-				elem = n;
-				break;
-			}
-			n = (n + 1) % ID_ELEMS;
+		mask = idsum[s];
+		if (s == elem / WBITS)
+			mask &= ~((word_t) 0) << (elem % WBITS);
+		if (mask)
+		{
+			elem = s * WBITS + lsb_index(mask);
+			return elem * WBITS + lsb_index(idfree[elem]);
 		}
-		while (n != start);
 	}
 
+	return -1;
+}
+
+/*!
+ * Allocate and return unique id for new system resource
+ * \param type Object type (KTYPE_*)
+ * \param object Object that will be registered with new id
+ * \return new id
+ */
+id_t k_new_id(int type, void *object)
+{
+	id_t id;
+	uint elem;
+
+	/* search forward from last given id (ids are not reused at once) */
+	id = k_find_free_id(last_id + 1);
+	if (id == -1)
+		id = k_find_free_id(1);
+
 	ASSERT(id != -1);
 
-	idmask [ elem ] |= (1 << id);	/* reserve ID */
-	id += elem * WBITS;
+	elem = id / WBITS;
+	idfree[elem] &= ~(((word_t) 1) << (id % WBITS));	/* reserve ID */
+	if (!idfree[elem])
+		idsum[elem / WBITS] &= ~(((word_t) 1) << (elem % WBITS));
+
+	idobj[id].object = object;
+	idobj[id].type = type;
+
 	last_id = id;
 
 	return id;
@@ -204,64 +554,522 @@ id_t k_new_id()
 /*! Release resource id */
 void k_free_id(id_t id)
 {
+	uint elem = id / WBITS;
+
 	ASSERT(id > 0 && id < MAX_RES &&
-		(idmask [ id / WBITS ] &(1 << (id % WBITS))));
+		!(idfree[elem] & (((word_t) 1) << (id % WBITS))));
+
+	idfree[elem] |= ((word_t) 1) << (id % WBITS);
+	idsum[elem / WBITS] |= ((word_t) 1) << (elem % WBITS);
 
-	idmask [ id / WBITS ] &= ~(1 << (id % WBITS));
+	idobj[id].object = NULL;
+	idobj[id].type = KTYPE_NONE;
 }
 
 /*! Check if "id" is used (if object is alive) */
 int k_check_id(id_t id)
 {
-	if (
-		id < 1 || id >= MAX_RES ||
-		(idmask [ id / WBITS ] &(1 << (id % WBITS))) == 0
-	)
-		return 0;
-	else
-		return 1;
+	return id > 0 && id < MAX_RES && idobj[id].type != KTYPE_NONE;
+}
 
+/*!
+ * Get object registered with 'id'
+ * \param id Object id
+ * \param type Expected object type (KTYPE_*)
+ * \return object, NULL if 'id' is not used or object is of other type
+ */
+void *k_id_object(id_t id, int type)
+{
+	if (id <= 0 || id >= MAX_RES || idobj[id].type != type)
+		return NULL;
+
+	return idobj[id].object;
 }
 
+#undef	SUM_ELEMS
 #undef	MAX_RES
 #undef	WBITS
 #undef	ID_ELEMS
 
 
-/* use bitmap to find free memory block for thread stack */
-void *kprocess_stack_alloc(kprocess_t *kproc)
+/*! Page frames and process address space ----------------------------------- */
+
+/*! frame pool: frames are taken from released list or from unused part */
+static void *frames_start, *frames_end;
+static void *frames_unused;	/* [frames_unused, frames_end) never used */
+static void *frames_released;	/* list of released frames (link in frame) */
+static uint frames_total, frames_free;
+
+/*! shared page for reads from untouched process pages (outside pool) */
+static char zero_page[PAGE_SIZE] __attribute__ ((aligned (PAGE_SIZE)));
+
+/*! virtual address space for processes - bitmap of used slots */
+#define VSLOTS		((PROC_VEND - PROC_VSTART) / PROC_VSLOT)
+#define VBITS		(sizeof(uint) * 8)
+static uint vslots[(VSLOTS + VBITS - 1) / VBITS];
+
+static void k_frames_init(void *start, void *end)
 {
-	int i, j, m;
+	frames_start = PAGE_ALIGN_UP(start);
+	frames_end = PAGE_ALIGN_DOWN(end);
+	frames_unused = frames_start;
+	frames_released = NULL;
+	frames_total = frames_free = (frames_end - frames_start) / PAGE_SIZE;
 
-	m = (kproc->smap_size + sizeof(uint)*8 - 1) /(sizeof(uint)*8);
+	memset(vslots, 0, sizeof(vslots));
+}
 
-	/* find first 0 in stack mask */
-	for (i = 0; i < m; i++)
+/*! Get free page frame, NULL if none left */
+void *k_frame_alloc()
+{
+	void *frame;
+
+	if (frames_released)
+	{
+		frame = frames_released;
+		frames_released = *((void **) frame);
+	}
+	else if (frames_unused < frames_end)
+	{
+		frame = frames_unused;
+		frames_unused += PAGE_SIZE;
+	}
+	else if (k_drop_warm_process())
+	{
+		return k_frame_alloc();
+	}
+	else {
+		return NULL;
+	}
+
+	frames_free--;
+
+	return frame;
+}
+
+/*! Return page frame to pool */
+void k_frame_free(void *frame)
+{
+	ASSERT(frame >= frames_start && frame < frames_end);
+
+	*((void **) frame) = frames_released;
+	frames_released = frame;
+	frames_free++;
+}
+
+#define VSLOT_USED(I)	(vslots[(I) / VBITS] & (1 << ((I) % VBITS)))
+
+/*!
+ * Reserve address space for process memory segment (nothing is committed)
+ * \param kproc Process with defined segment size (kproc->m.size)
+ * \return 0 if successful, ENOMEM if no address space is left
+ */
+int kprocess_memory_init(kprocess_t *kproc)
+{
+	uint i, j, n;
+
+	kproc->m.start = NULL;
+	n = (kproc->m.size + PROC_VSLOT - 1) / PROC_VSLOT;
+
+	for (i = 0; i + n <= VSLOTS; i++)
 	{
-		if (kproc->smap[i] != (uint) -1)
+		for (j = 0; j < n && !VSLOT_USED(i + j); j++)
+			;
+		if (j == n)
 			break;
+		i += j; /* slot i + j is used */
 	}
-	if (i == m)
+	if (i + n > VSLOTS)
+		return ENOMEM;
+
+	for (j = i; j < i + n; j++)
+		vslots[j / VBITS] |= 1 << (j % VBITS);
+
+	kproc->m.start = (void *) PROC_VSTART + i * PROC_VSLOT;
+	kproc->m.type = MS_PROCESS;
+	kproc->pages = 0;
+
+	/* thread stacks are reserved from the end of segment, below clock page */
+	kproc->stack_low = kproc->m.start + kproc->m.size - PAGE_SIZE;
+	list_init(&kproc->free_stacks);
+	kproc->stacks_cached = 0;
+
+	return EXIT_SUCCESS;
+}
+
+/*! Release all process pages, page tables and address space */
+void kprocess_memory_free(kprocess_t *kproc)
+{
+	void *page, *frame, *end;
+	kstack_t *kstack;
+	uint i;
+
+	end = kproc->m.start + kproc->m.size;
+
+	kprocess_memory_release(kproc, kproc->m.start, end);
+
+	while ((kstack = list_remove(&kproc->free_stacks, FIRST, NULL)))
+		kfree(kstack);
+
+	for (page = kproc->m.start; page < end; page += PAGE_TABLE_SPAN)
+		if ((frame = arch_page_table_remove(page)) != NULL)
+			k_frame_free(frame);
+
+	for (page = kproc->m.start; page < end; page += PROC_VSLOT)
+	{
+		i = (page - (void *) PROC_VSTART) / PROC_VSLOT;
+		vslots[i / VBITS] &= ~(1 << (i % VBITS));
+	}
+
+	kproc->pages = 0;
+}
+
+/*! Unmap pages in [start, end) (both are page aligned) */
+static void kprocess_memory_release(kprocess_t *kproc, void *start, void *end)
+{
+	void *page, *frame;
+
+	/* frames outside frame pool are shared (from program image) */
+	for (page = start; page < end; page += PAGE_SIZE)
+	{
+		if ((frame = arch_page_unmap(page)) != NULL &&
+			frame >= frames_start && frame < frames_end)
+		{
+			k_frame_free(frame);
+			kproc->pages--;
+		}
+	}
+}
+
+/*!
+ * Reserve thread stack in process address space: stacks are placed from the
+ * end of process segment downward (towards heap), each with a guard page
+ * (never committed) below it; stack pages are committed on first access
+ * \param kproc Process
+ * \param size Requested stack size; actual (page aligned) size on return
+ * \return stack (lowest usable address), NULL if there is no space left
+ */
+void *kprocess_stack_alloc(kprocess_t *kproc, size_t *size)
+{
+	kstack_t *kstack;
+	void *start;
+	size_t need;
+
+	*size = (size_t) PAGE_ALIGN_UP(*size);
+	need = *size + PAGE_SIZE;
+
+	/* reuse released area, if there is large enough one */
+	kstack = list_get(&kproc->free_stacks, FIRST);
+	while (kstack && kstack->size < need)
+		kstack = list_get_next(&kstack->list);
+
+	if (kstack)
+	{
+		(void) list_remove(&kproc->free_stacks, 0, &kstack->list);
+		start = kstack->start;
+		*size = kstack->size - PAGE_SIZE;
+		if (kstack->cached)
+			kproc->stacks_cached--;
+		kfree(kstack);
+	}
+	else {
+		if (kproc->stack_low - need < kproc->brk ||
+			kproc->stack_low - need > kproc->stack_low)
+			return NULL; /* would overlap with heap */
+
+		kproc->stack_low -= need;
+		start = kproc->stack_low;
+	}
+
+	if (arch_page_map(start, NULL, PAGE_GUARD))
+	{
+		kprocess_stack_free(kproc, start + PAGE_SIZE, *size);
 		return NULL;
+	}
+
+	return start + PAGE_SIZE;
+}
+
+/*!
+ * Release thread stack (reserved with kprocess_stack_alloc); up to
+ * THREAD_CACHE_MAX stacks keep their pages, so next thread in the same
+ * process gets already committed stack
+ */
+void kprocess_stack_free(kprocess_t *kproc, void *stack, size_t size)
+{
+	kstack_t *kstack;
+	void *start = stack - PAGE_SIZE;
+	int cached = kproc->stacks_cached < THREAD_CACHE_MAX;
+
+	size += PAGE_SIZE;
+
+	if (!cached)
+		kprocess_memory_release(kproc, start, start + size);
+
+	if (cached || start != kproc->stack_low)
+	{
+		kstack = kmalloc(sizeof(kstack_t));
+		ASSERT(kstack);
+		kstack->start = start;
+		kstack->size = size;
+		kstack->cached = cached;
+		if (cached)
+			kproc->stacks_cached++;
+		list_append(&kproc->free_stacks, kstack, &kstack->list);
+		return;
+	}
+
+	/* lowest stack released: move limit up, over released areas too */
+	kproc->stack_low += size;
+
+	kstack = list_get(&kproc->free_stacks, FIRST);
+	while (kstack)
+	{
+		if (kstack->start == kproc->stack_low)
+		{
+			(void) list_remove(&kproc->free_stacks, 0,
+					    &kstack->list);
+			if (kstack->cached)
+			{
+				kprocess_memory_release(kproc, kstack->start,
+					kstack->start + kstack->size);
+				kproc->stacks_cached--;
+			}
+			kproc->stack_low += kstack->size;
+			kfree(kstack);
+			kstack = list_get(&kproc->free_stacks, FIRST);
+		}
+		else {
+			kstack = list_get_next(&kstack->list);
+		}
+	}
+}
+
+/*!
+ * Load program into process memory:
+ * - header is copied (it is changed in runtime)
+ * - text and read only data are mapped from program image (shared)
+ * - data is mapped from program image as copy on write
+ * - .bss and heap are zero filled when used
+ * Pages which are not page aligned in image are copied.
+ * \param kproc Process (address space is already reserved)
+ * \param kprog Program
+ * \return 0 if successful, ENOMEM if there are no free frames
+ */
+int kprocess_memory_load(kprocess_t *kproc, kprog_t *kprog)
+{
+	clock_page_t *clock = arch_clock_page();
+
+	if (kprocess_memory_map(kproc, kprog, FALSE))
+		return ENOMEM;
+
+	/* last page of segment: clock page (shared, read only) */
+	if (clock && arch_page_map(kproc->m.start + kproc->m.size - PAGE_SIZE,
+				     clock, PAGE_READ))
+		return ENOMEM;
+
+	return EXIT_SUCCESS;
+}
+
+/*!
+ * Return process address space to state after kprocess_memory_load, so it
+ * can be reused for new process of the same program: header is copied
+ * again, private copies of data are replaced with copy on write mappings,
+ * .bss, heap and stacks are released (text and page tables are kept)
+ * \param kproc Process (no threads left)
+ * \param kprog Program loaded in 'kproc'
+ * \return 0 if successful, ENOMEM if there are no free frames
+ */
+int kprocess_memory_reset(kprocess_t *kproc, kprog_t *kprog)
+{
+	kstack_t *kstack;
+
+	if (kprocess_memory_map(kproc, kprog, TRUE))
+		return ENOMEM;
+
+	kprocess_memory_release(kproc, kproc->m.start + kprog->size,
+				 kproc->m.start + kproc->m.size - PAGE_SIZE);
+
+	while ((kstack = list_remove(&kproc->free_stacks, FIRST, NULL)))
+		kfree(kstack);
+	kproc->stacks_cached = 0;
+	kproc->stack_low = kproc->m.start + kproc->m.size - PAGE_SIZE;
+
+	return EXIT_SUCCESS;
+}
+
+/*! Map program segments into process (see kprocess_memory_load/reset) */
+static int kprocess_memory_map(kprocess_t *kproc, kprog_t *kprog, int reset)
+{
+	kprog_seg_t *seg;
+	size_t offset, from, to, fend;
+	void *page, *frame, *src;
+	int flags;
+	uint i;
+
+	for (i = 0; i < kprog->segs; i++)
+	{
+		seg = &kprog->seg[i];
+		fend = seg->vaddr + seg->filesz;
+
+		for (offset = (size_t) PAGE_ALIGN_DOWN(seg->vaddr);
+			offset < fend; offset += PAGE_SIZE)
+		{
+			page = kproc->m.start + offset;
+			src = seg->data + offset - seg->vaddr;
+
+			if (offset < kprog->text || offset < seg->vaddr ||
+				offset + PAGE_SIZE > fend ||
+				((aint) src & (PAGE_SIZE - 1)))
+			{
+				/* private copy of (part of) page */
+				from = offset < seg->vaddr ? seg->vaddr : offset;
+				to = offset + PAGE_SIZE < fend ?
+					offset + PAGE_SIZE : fend;
+
+				if (k_memory_commit(kproc, page, PAGE_SIZE))
+					return ENOMEM;
+				memcpy(kproc->m.start + from,
+					seg->data + from - seg->vaddr, to - from);
+				if (reset && to == fend)
+					memset(kproc->m.start + to, 0,
+						offset + PAGE_SIZE - to);
+				continue;
+			}
+
+			flags = offset < kprog->data ? PAGE_READ : PAGE_COPY;
+
+			if (reset)
+			{
+				if (flags == PAGE_READ)
+					continue; /* text is not changed */
+
+				flags = arch_page_flags(page);
+				if (flags != -1 && (flags & PAGE_COPY))
+					continue; /* not changed */
+
+				if ((frame = arch_page_unmap(page)) != NULL)
+				{
+					k_frame_free(frame);
+					kproc->pages--;
+				}
+				flags = PAGE_COPY;
+			}
 
-	j = lsb_index(~kproc->smap[i]);
+			if (arch_page_map(page, src, flags))
+				return ENOMEM;
+		}
 
-	kproc->smap[i] |= 1<<j;
+		/* .bss (part not in last copied page) */
+		if (reset)
+			kprocess_memory_release(kproc,
+				PAGE_ALIGN_UP(kproc->m.start + fend),
+				PAGE_ALIGN_UP(kproc->m.start + seg->vaddr +
+					       seg->memsz));
+	}
 
-	return kproc->stack + kproc->thread_stack_size * j;
+	/* image linked at other address: adjust pointers */
+	for (i = 0; kprog->base && i < kprog->relnum; i++)
+	{
+		if (ELF32_R_TYPE(kprog->rel[i].r_info) != ELF_R_RELATIVE)
+			continue;
+
+		offset = kprog->rel[i].r_offset - kprog->base;
+		if (offset + sizeof(uint32) > kprog->size)
+			continue;
+
+		page = kproc->m.start + offset;
+		if (k_memory_commit(kproc, page, sizeof(uint32)))
+			return ENOMEM;
+		*((uint32 *) page) -= kprog->base;
+	}
+
+	return EXIT_SUCCESS;
 }
-/* free thread stack */
-void kprocess_stack_free(kprocess_t *kproc, void *stack)
+
+/*!
+ * Commit pages for range in process address space: map zero filled pages
+ * where there are none, make private copies of copy on write pages
+ * \param kproc Process
+ * \param kadr Start of range (kernel address)
+ * \param size Range size; range is trimmed to process segment
+ * \return 0 if successful, ENOMEM if there are no free frames
+ */
+int k_memory_commit(kprocess_t *kproc, void *kadr, size_t size)
 {
-	int i, j;
+	void *page, *end, *frame, *old;
+	int flags;
 
-	j = ((uint) stack - (uint) kproc->stack) / kproc->thread_stack_size;
-	i = j /(sizeof(uint) * 8);
-	j %= (sizeof(uint) * 8);
+	if (!kproc->m.start || kadr < kproc->m.start)
+		return EXIT_SUCCESS; /* kernel "process" is not paged */
 
-	kproc->smap[i] &= ~(1<<j);
+	end = kadr + size;
+	if (end > kproc->m.start + kproc->m.size || end < kadr)
+		end = kproc->m.start + kproc->m.size;
+
+	for (page = PAGE_ALIGN_DOWN(kadr); page < end; page += PAGE_SIZE)
+	{
+		flags = arch_page_flags(page);
+		if (flags == PAGE_GUARD)
+			continue; /* stack overflow (kernel will fault) */
+		if (flags != -1 && !(flags & PAGE_COPY))
+			continue; /* already committed */
+
+		old = arch_page_frame(page);
+
+		frame = k_frame_alloc();
+		if (!frame)
+			return ENOMEM;
+
+		if (old)
+			memcpy(frame, old, PAGE_SIZE);
+		else
+			memset(frame, 0, PAGE_SIZE);
+
+		if (arch_page_map(page, frame, PAGE_WRITE))
+		{
+			k_frame_free(frame);
+			return ENOMEM;
+		}
+		kproc->pages++;
+		if (kproc->pages > kproc->pages_max)
+			kproc->pages_max = kproc->pages;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/*!
+ * Make pages in range present for kernel reads: pages that were never
+ * touched are mapped to shared zero page, as copy on write (no frames are
+ * used until process or kernel writes there, see k_memory_commit)
+ * \param kproc Process
+ * \param kadr Start of range (kernel address)
+ * \param size Range size; range is trimmed to process segment
+ * \return 0 if successful, ENOMEM if page table couldn't be created
+ */
+int k_memory_present(kprocess_t *kproc, void *kadr, size_t size)
+{
+	void *page, *end;
+
+	if (!kproc->m.start || kadr < kproc->m.start)
+		return EXIT_SUCCESS; /* kernel "process" is not paged */
+
+	end = kadr + size;
+	if (end > kproc->m.start + kproc->m.size || end < kadr)
+		end = kproc->m.start + kproc->m.size;
+
+	for (page = PAGE_ALIGN_DOWN(kadr); page < end; page += PAGE_SIZE)
+		if (arch_page_flags(page) == -1 &&
+			arch_page_map(page, zero_page, PAGE_COPY))
+			return ENOMEM;
+
+	return EXIT_SUCCESS;
 }
 
+#undef	VSLOT_USED
+#undef	VSLOTS
+#undef	VBITS
 
 
 /*!
@@ -309,21 +1117,50 @@ void k_memory_info()
 		 "Type\tsize\t\tstart addres\n"
 	);
 
-	for (i = 0; mseg[i].type != MS_END && i < 20; i++)
+	for (i = 0; mseg[i].type != MS_END; i++)
 	{
 		kprintf("%d\t%x\t%x\n", mseg[i].type, mseg[i].size,
 					  mseg[i].start);
 	}
+
+	kprintf("Page frames: %d free of %d (%x-%x)\n", frames_free,
+		 frames_total, frames_start, frames_end);
 }
 
 /*! Handle memory fault interrupt(and others undefined) */
-void k_memory_fault()
+void k_memory_fault(uint inum)
 {
+	kprocess_t *kproc;
+	void *adr;
+	int flags;
+
+	if (inum == INT_PAGE_FAULT && arch_prev_mode() == USER_MODE)
+	{
+		/* first access to process page (heap, stack) - demand-zero;
+		 * first write to data page - copy on write */
+		adr = arch_page_fault_adr();
+		kproc = kthread_get_process(NULL);
+		flags = arch_page_flags(adr);
+
+		if (kproc->m.start && adr >= kproc->m.start &&
+			adr < kproc->m.start + kproc->m.size &&
+			(adr < kproc->brk || adr >= kproc->stack_low) &&
+			(flags == -1 || (flags & PAGE_COPY)) &&
+			k_memory_commit(kproc, adr, 1) == EXIT_SUCCESS)
+			return; /* repeat instruction, now with page present */
+
+		if (flags == PAGE_GUARD)
+			LOG(ERROR, "Thread stack overflow (%x)!", adr);
+		else
+			LOG(ERROR, "Page fault on %x!", adr);
+	}
+
 	LOG(ERROR, "Undefined fault(exception)!!!");
 
 	if (arch_prev_mode() == KERNEL_MODE)
 	{
 		LOG(ERROR, "PANIC: kernel caused GPF!");
+		kprint_flush();
 		halt();
 	}
 	else {
@@ -333,14 +1170,52 @@ void k_memory_fault()
 	}
 }
 
+/*!
+ * Change process break (end of heap); memory up to break is committed on
+ * first access, pages above lowered break are released
+ * \param addr New break (user address); NULL only returns current one
+ * \return new (or current) break, -1 if break can't be set there (ENOMEM)
+ */
+int sys__brk(void *p)
+{
+	void *addr, *old;
+	kprocess_t *kproc = kthread_get_process(NULL);
+
+	addr = *((void **) p);
+
+	ASSERT_ERRNO_AND_EXIT(kproc->m.start, EINVAL); /* kernel threads */
+
+	if (addr)
+	{
+		if ((aint) addr > kproc->m.size)
+			EXIT(ENOMEM);
+
+		addr += (aint) kproc->m.start;
+		if (addr < kproc->heap || addr > kproc->stack_low)
+			EXIT(ENOMEM);
+
+		old = kproc->brk;
+		kproc->brk = addr;
+
+		if (addr < old)
+			kprocess_memory_release(kproc, PAGE_ALIGN_UP(addr),
+						  PAGE_ALIGN_UP(old));
+	}
+
+	EXIT2(EXIT_SUCCESS, kproc->brk - kproc->m.start);
+}
+
 /*! printf (or return) system information (and details) */
 int sys__sysinfo(void *p)
 {
 	char *buffer;
 	size_t buf_size;
 	char **param; /* last param is NULL */
-	char *param1; /* *param0; */
-	char usage[] = "Usage: sysinfo [programs|threads|memory]";
+	char *param1, *param2; /* *param0; */
+	int level;
+	char usage[] =
+		"Usage: sysinfo [programs|threads|memory|interrupts|devices|"
+		"loglevel [0-5]]";
 	char look_console[] = " (sysinfo printed on console)";
 
 	buffer = *((char **) p); p += sizeof(char *);
@@ -349,6 +1224,8 @@ int sys__sysinfo(void *p)
 	buffer = U2K_GET_ADR(buffer, kthread_get_process(NULL));
 
 	buf_size = *((size_t *) p); p += sizeof(size_t *);
+	if (k_memory_commit(kthread_get_process(NULL), buffer, buf_size))
+		EXIT(ENOMEM);
 
 	param = *((char ***) p);
 	param = U2K_GET_ADR(param, kthread_get_process(NULL));
@@ -394,6 +1271,47 @@ int sys__sysinfo(void *p)
 			EXIT(EXIT_SUCCESS);
 			/* TODO: "thread id" */
 		}
+		else if (strcmp("interrupts", param1) == 0)
+		{
+			k_interrupt_info();
+			if (strlen(look_console) > buf_size)
+				EXIT(ENOMEM);
+			strcpy(buffer, look_console);
+			EXIT(EXIT_SUCCESS);
+		}
+		else if (strcmp("loglevel", param1) == 0)
+		{
+			/* change log level (if given) and print current */
+			if (param[2])
+			{
+				param2 = U2K_GET_ADR(param[2],
+						       kthread_get_process(NULL));
+				if (!param2 || param2[0] < '0' ||
+					param2[0] > '9' || param2[1])
+				{
+					if (strlen(usage) > buf_size)
+						EXIT(ENOMEM);
+					strcpy(buffer, usage);
+					EXIT(EINVAL);
+				}
+				klog_set_level(param2[0] - '0');
+			}
+			level = klog_set_level(-1); /* invalid level: only read */
+
+			if (buf_size < 16)
+				EXIT(ENOMEM);
+			strcpy(buffer, "log level: ");
+			itoa(buffer + strlen(buffer), 'd', level);
+			EXIT(EXIT_SUCCESS);
+		}
+		else if (strcmp("devices", param1) == 0)
+		{
+			k_device_info();
+			if (strlen(look_console) > buf_size)
+				EXIT(ENOMEM);
+			strcpy(buffer, look_console);
+			EXIT(EXIT_SUCCESS);
+		}
 		else {
 			if (strlen(usage) > buf_size)
 				EXIT(ENOMEM);
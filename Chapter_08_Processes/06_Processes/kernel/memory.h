@@ -32,6 +32,8 @@ extern MEM_ALLOC_T *k_mpool; /* defined in *ff_simple.c, *gma.h, ... */
 
 /*! Kernel memory layout ---------------------------------------------------- */
 #include <types/basic.h>
+#include <types/time.h>
+#include <types/elf.h>
 #include <lib/list.h>
 #include <api/prog_info.h>
 #include <arch/memory.h>
@@ -40,20 +42,58 @@ void k_memory_init();
 void k_memory_info();
 
 
+/*! Part of program image loaded into process (ELF PT_LOAD segment) */
+typedef struct _kprog_seg_t_
+{
+	size_t	    vaddr;
+		    /* offset in process address space */
+	void	   *data;
+		    /* image data for [vaddr, vaddr + filesz) */
+	size_t	    filesz;
+	size_t	    memsz;
+		    /* [vaddr + filesz, vaddr + memsz) is zero filled */
+}
+kprog_seg_t;
+
+#define KPROG_SEGS	4
+
 /*! Available (loaded) programs */
 struct _kprog_t_
 {
 	program_t  *prog;
-		    /* defined as header of program */
+		    /* defined as header of program (in image) */
+
+	size_t	    size;
+		    /* program size in process memory (page aligned) */
+
+	size_t	    text;
+	size_t	    data;
+		    /* [text, data) is shared, [data, ...) copy on write */
+
+	kprog_seg_t seg[KPROG_SEGS];
+	uint	    segs;
+		    /* image parts to load */
 
-	mseg_t     *m;
-		    /* memory segment this program occupies */
+	size_t	    base;
+	elf32_rel_t *rel;
+	uint	    relnum;
+		    /* link address and relocations (if base is not 0) */
+
+	kprog_t    *hash_next;
+		    /* next program in the same hash bucket */
+
+	list_t      warm;
+		    /* address spaces of exited processes, ready for reuse */
+	uint        warm_count;
 
 	list_h      list;
 };
 
 /*! Process ----------------------------------------------------------------- */
 
+/*! Process object (id, exit status); defined in thread.h */
+typedef struct _kpid_t_ kpid_t;
+
 /*! Process */
 struct _kprocess_t_
 {
@@ -64,17 +104,24 @@ struct _kprocess_t_
 		      /* process header - at start of process memory */
 
 	char          name[16];	/* program name */
+	kprog_t      *kprog;	/* program this process runs */
 
-	void         *heap; /* physical address of heap area */
+	void         *heap; /* kernel address of heap area */
 	size_t        heap_size;
+	void         *brk;  /* end of heap (can be changed with brk) */
+
+	size_t        stack_size; /* expected space for all thread stacks */
+	size_t        thread_stack_size; /* default thread stack size */
+	void         *stack_low; /* lowest address of thread stacks */
+	list_t        free_stacks; /* released thread stacks (kstack_t) */
+	uint          stacks_cached; /* released stacks with pages kept */
 
-	void         *stack; /* physical address of stack area */
-	size_t        stack_size;
-	size_t        thread_stack_size;
-	uint         *smap; /* bitmap for stack allocation */
-	              /* allocation unit = thread_stack */
-		      /* allocation units = stack_size / thread_stack */
-	uint          smap_size;
+	uint          pages;	/* committed (private) pages */
+	uint          pages_max; /* peak of 'pages' */
+
+	kpid_t       *pid;	/* process object (NULL for kernel) */
+	void         *main_thread; /* first thread (gives exit status) */
+	timespec_t    cpu_time;	/* processor time used by threads */
 
 	uint          prio;	/* default priority for threads */
 
@@ -86,6 +133,20 @@ struct _kprocess_t_
 	list_h	      list;
 };
 
+/*! Released thread stack area in process (guard page + stack) */
+typedef struct _kstack_t_
+{
+	void	*start;
+		 /* guard page address */
+	size_t	 size;
+		 /* area size, including guard page */
+	int	 cached;
+		 /* are stack pages kept (still committed) */
+
+	list_h	 list;
+}
+kstack_t;
+
 /*! Object referenced in process (kernel object reference + additional info) */
 struct _kobject_t_
 {
@@ -105,17 +166,44 @@ struct _kobject_t_
 /* -------------------------------------------------------------------------- */
 /*! kernel ids, objects */
 
-id_t k_new_id();
+/*! object types (for id registry) */
+enum {
+	KTYPE_NONE = 0,
+	KTYPE_THREAD,
+	KTYPE_DEVICE,
+	KTYPE_MUTEX,
+	KTYPE_COND,
+	KTYPE_SEM,
+	KTYPE_MQUEUE,
+	KTYPE_TIMER,
+	KTYPE_PROCESS
+};
+
+id_t k_new_id(int type, void *object);
 void k_free_id(id_t id);
 int k_check_id(id_t id);
+void *k_id_object(id_t id, int type);
 
 int k_list_programs(char *buffer, size_t buf_size);
 
-void k_memory_fault(); /* memory fault handler */
+void k_memory_fault(uint inum); /* memory fault handler */
+
+/*! top of thread stack written by kernel (errno, initial thread frame) */
+#define STACK_TOP_COMMIT	64
+
+void *k_frame_alloc();
+void k_frame_free(void *frame);
+int kprocess_memory_init(kprocess_t *kproc);
+int kprocess_memory_load(kprocess_t *kproc, kprog_t *kprog);
+int kprocess_memory_reset(kprocess_t *kproc, kprog_t *kprog);
+kprog_t *k_find_program(char *name);
+void kprocess_memory_free(kprocess_t *kproc);
+int k_memory_commit(kprocess_t *kproc, void *kadr, size_t size);
+int k_memory_present(kprocess_t *kproc, void *kadr, size_t size);
 
 void *kmalloc_kobject(kprocess_t *proc, size_t obj_size);
 void *kfree_kobject(kprocess_t *proc, kobject_t *kobj);
 int   kfree_process_kobjects(kprocess_t *proc);
 
-void *kprocess_stack_alloc(kprocess_t *kproc);
-void kprocess_stack_free(kprocess_t *kproc, void *stack);
+void *kprocess_stack_alloc(kprocess_t *kproc, size_t *size);
+void kprocess_stack_free(kprocess_t *kproc, void *stack, size_t size);
@@ -68,6 +68,14 @@ int sys__pthread_create(void *p)
 		}
 	}
 
+	if (thread)
+	{
+		thread = U2K_GET_ADR(thread, kthread_get_process(NULL));
+		if (k_memory_commit(kthread_get_process(NULL), thread,
+				      sizeof(pthread_t)))
+			EXIT(ENOMEM);
+	}
+
 	kthread = kthread_create(start_routine, arg, flags,
 				   sched_policy, sched_priority,
 				   stackaddr, stacksize,
@@ -78,7 +86,6 @@ int sys__pthread_create(void *p)
 
 	if (thread)
 	{
-		thread = U2K_GET_ADR(thread, kthread_get_process(NULL));
 		thread->ptr = kthread;
 		thread->id = kthread_get_id(kthread);
 	}
@@ -124,14 +131,18 @@ int sys__pthread_join(void *p)
 
 	ASSERT_ERRNO_AND_EXIT(thread, ESRCH);
 	thread = U2K_GET_ADR(thread, kthread_get_process(NULL));
-	ASSERT_ERRNO_AND_EXIT(thread->ptr, ESRCH);
 
 	if (retval)
+	{
 		retval = U2K_GET_ADR(retval, kthread_get_process(NULL));
+		if (k_memory_commit(kthread_get_process(NULL), retval,
+				      sizeof(void *)))
+			EXIT(ENOMEM);
+	}
 
-	kthread = thread->ptr;
+	kthread = kthread_get_descriptor(thread);
 
-	if (kthread_get_id(kthread) != thread->id)
+	if (!kthread)
 	{
 		/* at 'kthread' is now something else */
 		ret_value = EXIT_FAILURE;
@@ -169,6 +180,9 @@ int sys__pthread_self(void *p)
 	thread = U2K_GET_ADR(*((void **) p), kthread_get_process(NULL));
 
 	ASSERT_ERRNO_AND_EXIT(thread, ESRCH);
+	if (k_memory_commit(kthread_get_process(NULL), thread,
+			      sizeof(pthread_t)))
+		EXIT(ENOMEM);
 
 	thread->ptr = kthread_get_active();
 	thread->id = kthread_get_id(NULL);
@@ -197,10 +211,9 @@ int sys__pthread_setschedparam(void *p)
 
 	thread = U2K_GET_ADR(thread, kthread_get_process(NULL));
 
-	kthread = thread->ptr;
-	ASSERT_ERRNO_AND_EXIT(kthread, EINVAL);
-	ASSERT_ERRNO_AND_EXIT(kthread_get_id(kthread) == thread->id, ESRCH);
-	ASSERT_ERRNO_AND_EXIT(kthread_is_alive(kthread), ESRCH);
+	kthread = kthread_get_descriptor(thread);
+	if (!kthread || !kthread_is_alive(kthread))
+		EXIT(ESRCH);
 
 	ASSERT_ERRNO_AND_EXIT(policy >= 0 && policy < SCHED_NUM, EINVAL);
 
@@ -285,16 +298,50 @@ int sys__posix_spawn(void *p)
 	if (!kthread)
 		EXIT(ENOMEM);
 
-	if (pid) /* save thread descriptor */
+	if (pid) /* save process descriptor */
 	{
 		pid = U2K_GET_ADR(pid, proc);
-		pid->ptr = kthread;
-		pid->id = kthread_get_id(kthread);
+		if (k_memory_commit(proc, pid, sizeof(pid_t)))
+			EXIT(ENOMEM);
+		kprocess_get_pid(kthread_get_process(kthread), pid);
 	}
 
 	return EXIT_SUCCESS;
 }
 
+/*!
+ * Wait for child process to finish
+ * \param pid Child process (any child if pid->ptr == NULL); on return child
+ *            that is collected
+ * \param status Where to store child exit status
+ * \param options WNOHANG or 0
+ * \param usage Where to store resources used by child (if not NULL)
+ * \return 0 if successful, -1 otherwise
+ */
+int sys__waitpid(void *p)
+{
+	kthread_t *kthread;
+	int retval;
+
+	kthread = kthread_get_active();
+
+	retval = kprocess_wait(p, kthread);
+
+	if (retval == -EAGAIN)
+		kthreads_schedule(); /* blocked; result is set when released */
+
+	if (retval >= 0)
+	{
+		kthread_set_errno(kthread, EXIT_SUCCESS);
+	}
+	else {
+		kthread_set_errno(kthread, -retval);
+		retval = EXIT_FAILURE;
+	}
+
+	return retval;
+}
+
 /*! Set and get current thread error status */
 int sys__set_errno(void *p)
 {
@@ -312,7 +359,8 @@ int sys__get_errno_ptr(void *p)
 
 	errno = U2K_GET_ADR(*((int **) p), kthread_get_process(NULL));
 
-	if (errno)
+	if (errno && !k_memory_commit(kthread_get_process(NULL), errno,
+				       sizeof(int *)))
 		*errno = K2U_GET_ADR(	kthread_get_errno_ptr(NULL),
 					kthread_get_process(NULL));
 
@@ -344,12 +392,14 @@ int sys__pthread_mutex_init(void *p)
 	proc = kthread_get_process(NULL);
 	mutex = U2K_GET_ADR(mutex, proc);
 	ASSERT_ERRNO_AND_EXIT(mutex, EINVAL);
+	if (k_memory_commit(proc, mutex, sizeof(pthread_mutex_t)))
+		EXIT(ENOMEM);
 
 	kobj = kmalloc_kobject(proc, sizeof(kpthread_mutex_t));
 	ASSERT_ERRNO_AND_EXIT(kobj, ENOMEM);
 	kmutex = kobj->kobject;
 
-	kmutex->id = k_new_id();
+	kmutex->id = k_new_id(KTYPE_MUTEX, kmutex);
 	kmutex->owner = NULL;
 	kmutex->flags = 0;
 	kmutex->ref_cnt = 1;
@@ -380,6 +430,8 @@ int sys__pthread_mutex_destroy(void *p)
 	proc = kthread_get_process(NULL);
 	mutex = U2K_GET_ADR(mutex, proc);
 	ASSERT_ERRNO_AND_EXIT(mutex, EINVAL);
+	if (k_memory_commit(proc, mutex, sizeof(pthread_mutex_t)))
+		EXIT(ENOMEM);
 
 	kobj = mutex->ptr;
 	ASSERT_ERRNO_AND_EXIT(kobj, EINVAL);
@@ -545,12 +597,14 @@ int sys__pthread_cond_init(void *p)
 	proc = kthread_get_process(NULL);
 	cond = U2K_GET_ADR(cond, proc);
 	ASSERT_ERRNO_AND_EXIT(cond, EINVAL);
+	if (k_memory_commit(proc, cond, sizeof(pthread_cond_t)))
+		EXIT(ENOMEM);
 
 	kobj = kmalloc_kobject(proc, sizeof(kpthread_cond_t));
 	ASSERT_ERRNO_AND_EXIT(kobj, ENOMEM);
 	kcond = kobj->kobject;
 
-	kcond->id = k_new_id();
+	kcond->id = k_new_id(KTYPE_COND, kcond);
 	kcond->flags = 0;
 	kcond->ref_cnt = 1;
 	kthreadq_init(&kcond->queue);
@@ -580,6 +634,8 @@ int sys__pthread_cond_destroy(void *p)
 	proc = kthread_get_process(NULL);
 	cond = U2K_GET_ADR(cond, proc);
 	ASSERT_ERRNO_AND_EXIT(cond, EINVAL);
+	if (k_memory_commit(proc, cond, sizeof(pthread_cond_t)))
+		EXIT(ENOMEM);
 
 	kobj = cond->ptr;
 	ASSERT_ERRNO_AND_EXIT(kobj, EINVAL);
@@ -761,12 +817,14 @@ int sys__sem_init(void *p)
 	proc = kthread_get_process(NULL);
 	sem = U2K_GET_ADR(sem, proc);
 	ASSERT_ERRNO_AND_EXIT(sem, EINVAL);
+	if (k_memory_commit(proc, sem, sizeof(sem_t)))
+		EXIT(ENOMEM);
 
 	kobj = kmalloc_kobject(proc, sizeof(ksem_t));
 	ASSERT_ERRNO_AND_EXIT(kobj, ENOMEM);
 	ksem = kobj->kobject;
 
-	ksem->id = k_new_id();
+	ksem->id = k_new_id(KTYPE_SEM, ksem);
 	ksem->sem_value = value;
 	ksem->last_lock = NULL;
 	ksem->flags = 0;
@@ -802,6 +860,8 @@ int sys__sem_destroy(void *p)
 	proc = kthread_get_process(NULL);
 	sem = U2K_GET_ADR(sem, proc);
 	ASSERT_ERRNO_AND_EXIT(sem, EINVAL);
+	if (k_memory_commit(proc, sem, sizeof(sem_t)))
+		EXIT(ENOMEM);
 
 	kobj = sem->ptr;
 	ASSERT_ERRNO_AND_EXIT(kobj, EINVAL);
@@ -957,6 +1017,8 @@ int sys__mq_open(void *p)
 	name = U2K_GET_ADR(name, proc);
 	mqdes = U2K_GET_ADR(mqdes, proc);
 	ASSERT_ERRNO_AND_EXIT(name && mqdes, EBADF);
+	if (k_memory_commit(proc, mqdes, sizeof(mqd_t)))
+		EXIT(ENOMEM);
 	ASSERT_ERRNO_AND_EXIT(strlen(name) < NAME_MAX, EBADF);
 
 
@@ -985,7 +1047,7 @@ int sys__mq_open(void *p)
 			kq_queue->attr = *attr;
 		}
 
-		kq_queue->id = k_new_id();
+		kq_queue->id = k_new_id(KTYPE_MQUEUE, kq_queue);
 		kq_queue->attr.mq_curmsgs = 0;
 
 		kq_queue->name = kmalloc(strlen(name) + 1);
@@ -1143,6 +1205,8 @@ static int kmq_send(void *p, kthread_t *sender)
 	mqdes = U2K_GET_ADR(mqdes, proc);
 	msg_ptr = U2K_GET_ADR(msg_ptr, proc);
 	ASSERT_ERRNO_AND_EXIT(mqdes && msg_ptr, EINVAL);
+	if (k_memory_present(proc, msg_ptr, msg_len))
+		EXIT(ENOMEM);
 
 	kobj = mqdes->ptr;
 	ASSERT_ERRNO_AND_EXIT(kobj, EBADF);
@@ -1268,6 +1332,15 @@ static int kmq_receive(void *p, kthread_t *receiver)
 	mqdes = U2K_GET_ADR(mqdes, proc);
 	msg_ptr = U2K_GET_ADR(msg_ptr, proc);
 	ASSERT_ERRNO_AND_EXIT(mqdes && msg_ptr, -EINVAL);
+	if (k_memory_commit(proc, msg_ptr, msg_len))
+		return -ENOMEM;
+	if (msg_prio)
+	{
+		msg_prio = U2K_GET_ADR(msg_prio, proc);
+		ASSERT_ERRNO_AND_EXIT(msg_prio, -EINVAL);
+		if (k_memory_commit(proc, msg_prio, sizeof(uint)))
+			return -ENOMEM;
+	}
 
 	kobj = mqdes->ptr;
 	ASSERT_ERRNO_AND_EXIT(kobj, -EBADF);
@@ -1299,11 +1372,7 @@ static int kmq_receive(void *p, kthread_t *receiver)
 	memcpy(msg_ptr, &kmq_msg->msg_data[0], kmq_msg->msg_size);
 	msg_len = kmq_msg->msg_size;
 	if (msg_prio)
-	{
-		msg_prio = U2K_GET_ADR(msg_prio, proc);
-		if (msg_prio)
-			*msg_prio = kmq_msg->msg_prio;
-	}
+		*msg_prio = kmq_msg->msg_prio;
 
 	kfree(kmq_msg);
 
@@ -156,6 +156,10 @@ void kthreads_schedule()
 	/* process pending signals (if any) */
 	ksignal_process_pending(kthread_get_active());
 
+	/* nothing else to do - print buffered kernel messages */
+	if (kthread_get_prio(kthread_get_active()) == THREAD_MIN_PRIO)
+		kprint_drain();
+
 	/* select 'active_thread' context */
 	arch_select_thread(kthread_get_context(NULL));
 }
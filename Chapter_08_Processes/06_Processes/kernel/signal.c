@@ -7,16 +7,24 @@
 #include <kernel/kprint.h>
 #include <kernel/errno.h>
 #include "time.h"
+#include "device.h"
 #include <arch/syscall.h>
 #include <kernel/syscall.h>
 
 static int ksignal_received_signal(kthread_t *kthread, void *param);
-static void ksignal_add_to_pending(ksignal_handling_t *sh, siginfo_t *sig);
+static void ksignal_wait_release(kthread_t *kthread);
+static void ksignal_wait_timeout(sigval_t sigval);
+static int ksignal_add_to_pending(ksignal_handling_t *sh, siginfo_t *sig);
+static int ksignal_first_pending(ksignal_handling_t *sh, sigset_t *set,
+				   int exclude);
+static void ksignal_take_pending(ksignal_handling_t *sh, int signo,
+				   siginfo_t *sig);
 
 /*! Initialize thread signal handling data */
 int ksignal_thread_init(kthread_t *kthread)
 {
 	ksignal_handling_t *sh;
+	int i;
 
 	ASSERT(kthread);
 
@@ -24,7 +32,15 @@ int ksignal_thread_init(kthread_t *kthread)
 
 	sigfillset(sh->mask); /* all signals are blocked */
 
-	list_init(&sh->pending_signals);
+	sigemptyset(&sh->pending);
+	for (i = 0; i <= SIGMAX; i++)
+		list_init(&sh->queued[i]);
+
+	list_init(&sh->free);
+	for (i = 0; i < SIGQUEUE_MAX; i++)
+		list_append(&sh->free, &sh->slot[i], &sh->slot[i].list);
+
+	list_init(&sh->signalfds);
 
 	return EXIT_SUCCESS;
 }
@@ -38,9 +54,6 @@ int ksignal_queue(kthread_t *kthread, siginfo_t *sig)
 	ksignal_handling_t *sh;
 	sigaction_t *act;
 	void (*func)(kthread_t *, void *), *param;
-	kprocess_t *proc;
-	siginfo_t *us;
-	param_t param1, param2, param3;
 
 	ASSERT(kthread);
 	ASSERT(kthread_check_kthread(kthread));
@@ -118,24 +131,11 @@ int ksignal_queue(kthread_t *kthread, siginfo_t *sig)
 			schedule = TRUE;
 		}
 
-		/* copy sig to user space */
-		proc = kthread_get_process(kthread);
-		us = kprocess_stack_alloc(proc);
-		ASSERT(us);
-		/*if (!us)
-			return ENOMEM;*/
-
-		*us = *sig;
-
-		kthread_create_new_state(kthread, act->sa_sigaction,
-					   K2U_GET_ADR(us, proc), NULL,
-					   HANDLER_STACK_SIZE, TRUE);
-
-		param1.p_ptr = proc;
-		param2.p_ptr = us;
-		param3.p_ptr = NULL;
-		kthread_add_cleanup(kthread, kprocess_stack_free,
-				      param1, param2, param3);
+		/* handler state and stack are preallocated (per nesting
+		 * level); sig is copied on handler stack */
+		if (kthread_create_handler_state(kthread, act->sa_sigaction,
+						   sig, sizeof(siginfo_t)))
+			return ENOMEM;
 
 		/* mask signal in thread mask */
 		sigaddset(sh->mask, sig->si_signo);
@@ -147,11 +147,7 @@ int ksignal_queue(kthread_t *kthread, siginfo_t *sig)
 	}
 
 	if (enqueue)
-	{
-		ksignal_add_to_pending(sh, sig);
-
-		retval = EAGAIN;
-	}
+		retval = ksignal_add_to_pending(sh, sig);
 
 	if (schedule)
 		kthreads_schedule();
@@ -159,17 +155,76 @@ int ksignal_queue(kthread_t *kthread, siginfo_t *sig)
 	return retval;
 }
 
-static void ksignal_add_to_pending(ksignal_handling_t *sh, siginfo_t *sig)
+/*!
+ * Queue signal in its FIFO, using preallocated element
+ * \return EAGAIN when queued (or standard signal is already pending),
+ *         ENOMEM when there are already SIGQUEUE_MAX pending signals
+ */
+static int ksignal_add_to_pending(ksignal_handling_t *sh, siginfo_t *sig)
 {
 	ksiginfo_t *ksig;
+	ksignalfd_t *ksfd;
+
+	/* standard signals are not queued: new instance is discarded */
+	if (sig->si_signo < SIGRTMIN && sigtestset(&sh->pending, sig->si_signo))
+		return EAGAIN;
+
+	ksig = list_remove(&sh->free, FIRST, NULL);
+	if (!ksig)
+		return ENOMEM;
 
-	/* add signal to list of pending signals */
-	ksig = kmalloc(sizeof(ksiginfo_t));
 	ksig->siginfo = *sig;
+	list_append(&sh->queued[sig->si_signo], ksig, &ksig->list);
+	sigaddset(&sh->pending, sig->si_signo);
+
+	/* wake readers of signalfds that accept this signal */
+	ksfd = list_get(&sh->signalfds, FIRST);
+	while (ksfd)
+	{
+		if (sigtestset(&ksfd->mask, sig->si_signo))
+			k_device_notify(ksfd->kdev);
 
-	list_append(&sh->pending_signals, ksig, &ksig->list);
-	/* list_sort_add(&sh->pending_signals, ksig, &ksig->list,
-			ksignal_compare); */
+		ksfd = list_get_next(&ksfd->list);
+	}
+
+	return EAGAIN;
+}
+
+/*!
+ * Find lowest pending signal that is in 'set' (or isn't, if 'exclude' is set)
+ * \return signal number, 0 if there is none
+ */
+static int ksignal_first_pending(ksignal_handling_t *sh, sigset_t *set,
+				   int exclude)
+{
+	uint bits;
+	int i;
+
+	for (i = 0; i < SIGSET_ELEMS; i++)
+	{
+		bits = sh->pending.set[i] &
+			(exclude ? ~set->set[i] : set->set[i]);
+		if (bits)
+			return i * 8 * sizeof(uint) + __builtin_ffs(bits) - 1;
+	}
+
+	return 0;
+}
+
+/*! Remove first queued instance of signal 'signo' and copy it to 'sig' */
+static void ksignal_take_pending(ksignal_handling_t *sh, int signo,
+				   siginfo_t *sig)
+{
+	ksiginfo_t *ksig;
+
+	ksig = list_remove(&sh->queued[signo], FIRST, NULL);
+	ASSERT(ksig);
+
+	*sig = ksig->siginfo;
+	list_append(&sh->free, ksig, &ksig->list);
+
+	if (!list_get(&sh->queued[signo], FIRST))
+		sigdelset(&sh->pending, signo);
 }
 
 /*! Process pending signals for thread (called from kthreads_schedule()) */
@@ -177,32 +232,28 @@ int ksignal_process_pending(kthread_t *kthread)
 {
 	ksignal_handling_t *sh;
 	int retval = EXIT_SUCCESS;
-	ksiginfo_t *ksig, *next;
+	siginfo_t sig;
+	int signo;
 
 	ASSERT(kthread);
 
 	sh = kthread_get_sigparams(kthread);
 
-	ksig = list_get(&sh->pending_signals, FIRST);
-	while (ksig)
-	{
-		next = list_get_next(&ksig->list);
+	/* usual case: nothing is pending or all pending signals are masked */
+	signo = ksignal_first_pending(sh, sh->mask, TRUE);
+	if (!signo || !kthread_get_interruptable(kthread))
+		return EXIT_SUCCESS;
 
-		if (!sigtestset(sh->mask, ksig->siginfo.si_signo))
-		{
-			list_remove(&sh->pending_signals, 0, &ksig->list);
-
-			retval = ksignal_queue(kthread, &ksig->siginfo);
-
-			kfree(ksig);
+	/* handle all of them - delivered ones are masked while handled */
+	while (signo)
+	{
+		ksignal_take_pending(sh, signo, &sig);
 
-			/* handle only first signal?
-				* no, all of them - they will mask ... */
-			/*if (retval == EXIT_SUCCESS)
-				break;*/
-		}
+		retval = ksignal_queue(kthread, &sig);
+		if (retval == EAGAIN || retval == ENOMEM)
+			break; /* queued again */
 
-		ksig = next;
+		signo = ksignal_first_pending(sh, sh->mask, TRUE);
 	}
 
 	return retval;
@@ -224,6 +275,8 @@ static int ksignal_received_signal(kthread_t *kthread, void *param)
 	/* thread waked by signal or other event? */
 	if (param == NULL)
 	{
+		ksignal_wait_release(kthread);
+
 		kthread_set_errno(kthread, EINTR);
 		kthread_set_syscall_retval(kthread, EXIT_FAILURE);
 
@@ -239,23 +292,26 @@ static int ksignal_received_signal(kthread_t *kthread, void *param)
 
 	switch(sysid)
 	{
-	case SIGWAITINFO: /* sigwaitinfo */
+	case SIGTIMEDWAIT: /* sigwaitinfo, sigtimedwait */
 		p = arch_syscall_get_params(context);
 
 		set =   *((sigset_t **) p);	p += sizeof(sigset_t *);
 		info =  *((siginfo_t **) p);	p += sizeof(siginfo_t *);
 
 		ASSERT(set);
-		set = U2K_GET_ADR(set, kthread_get_process(NULL));
+		set = U2K_GET_ADR(set, kthread_get_process(kthread));
 		ASSERT(set);
 
 		if (info)
-			info = U2K_GET_ADR(info, kthread_get_process(NULL));
+			info = U2K_GET_ADR(info, kthread_get_process(kthread));
+		/* 'info' was committed in sys__sigtimedwait */
 
 		retval = EXIT_FAILURE;
 
 		if (sigtestset(set, sig->si_signo))
 		{
+			ksignal_wait_release(kthread);
+
 			retval = sig->si_signo;
 			kthread_set_syscall_retval(kthread, retval);
 
@@ -280,6 +336,39 @@ static int ksignal_received_signal(kthread_t *kthread, void *param)
 	}
 }
 
+/*! Cancel timeout of thread that is released from sigtimedwait */
+static void ksignal_wait_release(kthread_t *kthread)
+{
+	ktimer_t *ktimer;
+
+	ktimer = kthread_get_private_param(kthread);
+	if (ktimer)
+	{
+		ktimer_delete(ktimer);
+		kthread_set_private_param(kthread, NULL);
+	}
+}
+
+/*! Timeout expired for thread blocked in sigtimedwait */
+static void ksignal_wait_timeout(sigval_t sigval)
+{
+	kthread_t *kthread = k_id_object(sigval.sival_int, KTYPE_THREAD);
+	void *func;
+
+	if (kthread && kthread_is_suspended(kthread, &func, NULL) &&
+		func == ksignal_received_signal)
+	{
+		ksignal_wait_release(kthread);
+
+		kthread_set_errno(kthread, EAGAIN);
+		kthread_set_syscall_retval(kthread, EXIT_FAILURE);
+
+		kthread_move_to_ready(kthread, LAST);
+	}
+
+	kthreads_schedule();
+}
+
 /*! Process event defined with sigevent_t */
 int ksignal_process_event(sigevent_t *evp, kthread_t *kthread, int code)
 {
@@ -303,10 +392,9 @@ int ksignal_process_event(sigevent_t *evp, kthread_t *kthread, int code)
 
 	case SIGEV_THREAD_ID:
 		pid = evp->sigev_notify_thread_id;
-		target = pid.ptr;
+		target = kthread_get_descriptor(&pid);
 
-		if (!target || !kthread_is_alive(target) ||
-			pid.id != kthread_get_id(target))
+		if (!target || !kthread_is_alive(target))
 			return ESRCH;
 
 	case SIGEV_SIGNAL:
@@ -349,7 +437,8 @@ int ksignal_process_event(sigevent_t *evp, kthread_t *kthread, int code)
 
 /*!
  * Send signal to thread (from thread)
- * \param pid Thread descriptor (user level descriptor)
+ * \param pid Thread or process descriptor (user level descriptor); signal
+ *            for process is given to its main thread
  * \param signo Signal number
  * \param sigval Parameter to send with signal
  * \return 0 if successful, -1 otherwise and appropriate error number is set
@@ -371,11 +460,12 @@ int sys__sigqueue(void *p)
 	ASSERT_ERRNO_AND_EXIT(signo > 0 && signo <= SIGMAX, EINVAL);
 
 	thread = (pthread_t) pid; /* pid_t should be pthread_t */
-	ASSERT_ERRNO_AND_EXIT(thread.ptr, EINVAL);
 
-	kthread = thread.ptr;
-	ASSERT_ERRNO_AND_EXIT(kthread_get_id(kthread) == thread.id, EINVAL);
-	ASSERT_ERRNO_AND_EXIT(kthread_check_kthread(kthread), EINVAL);
+	kthread = kthread_get_descriptor(&thread);
+	if (!kthread)
+		kthread = kprocess_main_thread(&pid);
+	if (!kthread || !kthread_is_alive(kthread))
+		EXIT(ESRCH);
 
 	sender.id = kthread_get_id(NULL);
 	sender.ptr = kthread_get_active();
@@ -416,10 +506,13 @@ int sys__pthread_sigmask(void *p)
 	sh = kthread_get_sigparams(NULL);
 
 	if (oset)
+	{
 		oset = U2K_GET_ADR(oset, kthread_get_process(NULL));
-
-	if (oset)
+		if (k_memory_commit(kthread_get_process(NULL), oset,
+				      sizeof(sigset_t)))
+			EXIT(ENOMEM);
 		*oset = *sh->mask;
+	}
 
 	switch(how)
 	{
@@ -471,7 +564,12 @@ int sys__sigaction(void *p)
 		act = U2K_GET_ADR(act, kthread_get_process(NULL));
 
 	if (oact)
+	{
 		oact = U2K_GET_ADR(oact, kthread_get_process(NULL));
+		if (k_memory_commit(kthread_get_process(NULL), oact,
+				      sizeof(sigaction_t)))
+			EXIT(ENOMEM);
+	}
 
 	sh = kthread_get_sigparams(NULL);
 
@@ -505,60 +603,326 @@ int sys__sigaction(void *p)
  * Wait for signal
  * \param set Signals thread is waiting for
  * \param info Where to save caught signal
+ * \param timeout Maximal time to wait (NULL to wait until signal arrives)
  * \return signal number if signal is caught,
- *         -1 otherwise and appropriate error number is set
+ *         -1 otherwise and appropriate error number is set (EAGAIN when
+ *         timeout expired)
  */
-int sys__sigwaitinfo(void *p)
+int sys__sigtimedwait(void *p)
 {
 	sigset_t *set;
 	siginfo_t *info;
+	timespec_t *timeout;
 
 	kthread_t *kthread;
+	kprocess_t *proc;
 	ksignal_handling_t *sh;
-	ksiginfo_t *ksig, *next;
-	int retval;
+	siginfo_t sig;
+	int signo;
+	ktimer_t *ktimer = NULL;
+	sigevent_t evp;
+	itimerspec_t itimer;
+
+	set =     *((sigset_t **) p);		p += sizeof(sigset_t *);
+	info =    *((siginfo_t **) p);		p += sizeof(siginfo_t *);
+	timeout = *((timespec_t **) p);
 
-	set =   *((sigset_t **) p);		p += sizeof(sigset_t *);
-	info =  *((siginfo_t **) p);
+	kthread = kthread_get_active();
+	proc = kthread_get_process(kthread);
 
 	ASSERT_ERRNO_AND_EXIT(set, EINVAL);
-	set = U2K_GET_ADR(set, kthread_get_process(NULL));
+	set = U2K_GET_ADR(set, proc);
 	ASSERT_ERRNO_AND_EXIT(set, EINVAL);
 
 	if (info)
-		info = U2K_GET_ADR(info, kthread_get_process(NULL));
+	{
+		info = U2K_GET_ADR(info, proc);
+		if (k_memory_commit(proc, info, sizeof(siginfo_t)))
+			EXIT(ENOMEM);
+	}
+
+	if (timeout)
+	{
+		timeout = U2K_GET_ADR(timeout, proc);
+		ASSERT_ERRNO_AND_EXIT(timeout && timeout->tv_sec >= 0 &&
+			timeout->tv_nsec >= 0 && timeout->tv_nsec < 1000000000L,
+			EINVAL);
+	}
 
-	kthread = kthread_get_active();
 	sh = kthread_get_sigparams(kthread);
 
 	/* first, search for such signal in pending signals */
-	ksig = list_get(&sh->pending_signals, FIRST);
-	while (ksig)
+	signo = ksignal_first_pending(sh, set, FALSE);
+	if (signo)
 	{
-		next = list_get_next(&ksig->list);
-
-		if (sigtestset(set, ksig->siginfo.si_signo))
-		{
-			retval = ksig->siginfo.si_signo;
-			if (info)
-				*info = ksig->siginfo;
-
-			list_remove(&sh->pending_signals, 0, &ksig->list);
-			kfree(ksig);
-
-			EXIT2(EXIT_SUCCESS, retval);
-		}
+		ksignal_take_pending(sh, signo, &sig);
+		if (info)
+			*info = sig;
 
-		ksig = next;
+		EXIT2(EXIT_SUCCESS, signo);
 	}
 
+	if (timeout && !TIME_IS_SET(timeout))
+		EXIT(EAGAIN);
+
 	/*
 	 * if no pending signal found that matches given mask
-	 * suspend thread until signal is received
+	 * suspend thread until signal is received (or timeout expires)
 	 */
+	if (timeout)
+	{
+		evp.sigev_notify = SIGEV_WAKE_THREAD;
+		evp.sigev_value.sival_int = kthread_get_id(kthread);
+		evp.sigev_notify_function = ksignal_wait_timeout;
+
+		if (ktimer_create(CLOCK_MONOTONIC, &evp, &ktimer, kthread))
+			EXIT(ENOMEM);
+
+		TIME_RESET(&itimer.it_interval);
+		itimer.it_value = *timeout;
+
+		ktimer_settime(ktimer, 0, &itimer, NULL);
+	}
+	kthread_set_private_param(kthread, ktimer);
+
 	kthread_suspend(kthread, ksignal_received_signal, NULL);
+
+	/* return values are set when thread is released */
+	SET_ERRNO(EINTR);
 	kthreads_schedule();
 
-	EXIT(EINTR); /* if other events wake thread */
+	return EXIT_FAILURE;
 }
 
+/*!
+ * Switch user threads from signal handler: end handler, but instead of
+ * interrupted code continue with user thread 'to' (saved with
+ * arch_switch_to_uthread); interrupted code is saved in 'from' (so it can be
+ * resumed the same way). Switch is made only if interrupted code used stack
+ * [stack, stack + size), i.e. user thread was running.
+ * \param from Where to save interrupted user thread
+ * \param to User thread to continue with
+ * \param stack Stack of interrupted user thread
+ * \param size Stack size
+ * \param resume Code that resumes interrupted thread (arch dependent)
+ * \return doesn't return if successful; -1 otherwise, but errno is not
+ *         changed (it belongs to interrupted code)
+ */
+int sys__sigswitch(void *p)
+{
+	ucontext_t *from, *to, next;
+	void *stack, *resume, *usp;
+	size_t size;
+
+	kprocess_t *proc;
+	kthread_t *kthread;
+	context_t *context;
+
+	from =   *((ucontext_t **) p);	p += sizeof(ucontext_t *);
+	to =     *((ucontext_t **) p);	p += sizeof(ucontext_t *);
+	stack =  *((void **) p);		p += sizeof(void *);
+	size =   *((size_t *) p);		p += sizeof(size_t);
+	resume = *((void **) p);
+
+	kthread = kthread_get_active();
+	proc = kthread_get_process(kthread);
+
+	/* return value is set here: on success context is replaced */
+	kthread_set_syscall_retval(kthread, EXIT_FAILURE);
+
+	context = kthread_get_interrupted_context(kthread);
+	if (!context || !from || !to || !stack)
+		return EXIT_FAILURE;
+
+	usp = arch_context_get_stack(context);
+	if (usp < stack + ARCH_UCONTEXT_FRAME || usp > stack + size)
+		return EXIT_FAILURE;
+
+	from = U2K_GET_ADR(from, proc);
+	to = U2K_GET_ADR(to, proc);
+	if (!from || !to || k_memory_commit(proc, from, sizeof(ucontext_t)) ||
+	    k_memory_commit(proc, U2K_GET_ADR(usp - ARCH_UCONTEXT_FRAME, proc),
+			     ARCH_UCONTEXT_FRAME))
+		return EXIT_FAILURE;
+
+	next = *to; /* 'from' may be the same */
+	arch_context_save_uthread(context, from, resume);
+	if (arch_context_load_uthread(context, &next))
+		return EXIT_FAILURE; /* interrupted context is unchanged */
+
+	/* end handler: interrupted (now changed) context is restored */
+	kthread_exit(kthread, NULL, FALSE);
+
+	return EXIT_SUCCESS;
+}
+
+/*! Signal descriptors (signalfd) ------------------------------------------- */
+
+static int ksignalfd_recv(void *data, size_t size, uint flags, device_t *dev);
+static int ksignalfd_status(uint flags, device_t *dev);
+static int ksignalfd_destroy(uint flags, void *params, device_t *dev);
+
+static device_t ksignalfd_dev = (device_t)
+{
+	.dev_name = "signalfd",
+
+	.irq_num = 	-1,
+	.irq_handler =	NULL,
+
+	.init =		NULL,
+	.destroy =	ksignalfd_destroy,
+	.send =		NULL,
+	.recv =		ksignalfd_recv,
+	.status =	ksignalfd_status,
+
+	.flags = 	DEV_TYPE_KERNEL | DEV_TYPE_NOTSHARED,
+	.params = 	NULL,
+};
+
+/*! Thread whose queues are read through signalfd (NULL if it is gone) */
+static kthread_t *ksignalfd_thread(ksignalfd_t *ksfd)
+{
+	if (k_id_object(ksfd->tid, KTYPE_THREAD) != ksfd->kthread ||
+		!kthread_is_alive(ksfd->kthread))
+		return NULL;
+
+	return ksfd->kthread;
+}
+
+/*!
+ * Read queued signals (only whole siginfo_t elements)
+ * \return number of bytes read, 0 if no signal from descriptor mask is
+ *         pending, -1 if thread is gone or buffer is too small
+ */
+static int ksignalfd_recv(void *data, size_t size, uint flags, device_t *dev)
+{
+	ksignalfd_t *ksfd = dev->params;
+	ksignal_handling_t *sh;
+	kthread_t *kthread;
+	siginfo_t *info = data;
+	int signo;
+
+	kthread = ksignalfd_thread(ksfd);
+	if (!kthread || size < sizeof(siginfo_t))
+		return -1;
+
+	sh = kthread_get_sigparams(kthread);
+
+	while (size >= sizeof(siginfo_t) &&
+		(signo = ksignal_first_pending(sh, &ksfd->mask, FALSE)))
+	{
+		ksignal_take_pending(sh, signo, info);
+		info++;
+		size -= sizeof(siginfo_t);
+	}
+
+	return (void *) info - data;
+}
+
+static int ksignalfd_status(uint flags, device_t *dev)
+{
+	ksignalfd_t *ksfd = dev->params;
+	kthread_t *kthread;
+
+	kthread = ksignalfd_thread(ksfd);
+	if (!kthread)
+		return -1;
+
+	if ((flags & DEV_IN_READY) && ksignal_first_pending(
+		kthread_get_sigparams(kthread), &ksfd->mask, FALSE))
+		return DEV_IN_READY;
+
+	return 0;
+}
+
+/*! Last descriptor is closed */
+static int ksignalfd_destroy(uint flags, void *params, device_t *dev)
+{
+	ksignalfd_t *ksfd = params;
+	ksignal_handling_t *sh;
+
+	/* thread descriptor may be reused: list is valid only in same thread */
+	if (k_id_object(ksfd->tid, KTYPE_THREAD) == ksfd->kthread)
+	{
+		sh = kthread_get_sigparams(ksfd->kthread);
+		if (list_find(&sh->signalfds, &ksfd->list))
+			list_remove(&sh->signalfds, 0, &ksfd->list);
+	}
+
+	kfree(ksfd);
+
+	return EXIT_SUCCESS;
+}
+
+/*!
+ * Create descriptor for reading signals queued for calling thread, or change
+ * signal mask of existing one; signals in mask should be blocked (otherwise
+ * they are delivered to handlers instead)
+ * \param desc Descriptor (existing one if desc->ptr is set)
+ * \param mask Signals that are read through descriptor
+ * \param flags Opening flags (O_NONBLOCK)
+ * \return 0 if successful, -1 otherwise and appropriate error number is set
+ */
+int sys__signalfd(void *p)
+{
+	descriptor_t *desc;
+	sigset_t *mask;
+	int flags;
+
+	kprocess_t *proc;
+	kthread_t *kthread;
+	kobject_t *kobj;
+	ksignalfd_t *ksfd;
+	ksignal_handling_t *sh;
+
+	desc =  *((descriptor_t **) p);	p += sizeof(descriptor_t *);
+	mask =  *((sigset_t **) p);		p += sizeof(sigset_t *);
+	flags = *((int *) p);
+
+	kthread = kthread_get_active();
+	proc = kthread_get_process(kthread);
+
+	ASSERT_ERRNO_AND_EXIT(desc && mask, EINVAL);
+	desc = U2K_GET_ADR(desc, proc);
+	ASSERT_ERRNO_AND_EXIT(desc, EINVAL);
+	if (k_memory_commit(proc, desc, sizeof(descriptor_t)))
+		EXIT(ENOMEM);
+	mask = U2K_GET_ADR(mask, proc);
+	ASSERT_ERRNO_AND_EXIT(mask, EINVAL);
+
+	if (desc->ptr)
+	{
+		/* change mask of existing descriptor */
+		kobj = desc->ptr;
+		ASSERT_ERRNO_AND_EXIT(list_find(&proc->kobjects, &kobj->list),
+					EINVAL);
+		ksfd = kobj->ptr;
+		ASSERT_ERRNO_AND_EXIT(ksfd && ksfd->kdev == kobj->kobject,
+					EINVAL);
+
+		ksfd->mask = *mask;
+
+		EXIT(EXIT_SUCCESS);
+	}
+
+	ksfd = kmalloc(sizeof(ksignalfd_t));
+	ASSERT_ERRNO_AND_EXIT(ksfd, ENOMEM);
+
+	ksfd->mask = *mask;
+	ksfd->kthread = kthread;
+	ksfd->tid = kthread_get_id(kthread);
+	sh = kthread_get_sigparams(kthread);
+	list_append(&sh->signalfds, ksfd, &ksfd->list);
+
+	ksfd->kdev = k_device_create(&ksignalfd_dev, ksfd);
+
+	kobj = k_device_descriptor(ksfd->kdev, flags, desc, proc);
+	if (!kobj)
+	{
+		k_device_close(ksfd->kdev); /* also frees ksfd */
+		EXIT(ENOMEM);
+	}
+	kobj->ptr = ksfd;
+
+	EXIT(EXIT_SUCCESS);
+}
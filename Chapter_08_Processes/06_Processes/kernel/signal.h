@@ -15,20 +15,7 @@ int ksignal_queue(kthread_t *receiver, siginfo_t *sig);
 int ksignal_process_pending(kthread_t *kthread);
 int ksignal_process_event(sigevent_t *evp, kthread_t *kthread, int code);
 
-struct _ksignal_handling_t_
-{
-	sigset_t    *mask;
-		     /* addres of mask saved in thread state */
-	sigaction_t  act[SIGMAX];
-
-	list_t	     pending_signals;
-		     /* siginfo_t elements */
-};
-
-#ifdef	_K_SIGNAL_C_
-/*! rest of the file is only for 'kernel/signal.c' -------------------------- */
-
-/* for queuing signals to thread */
+/* queued signal (in per signal FIFO or in list of free slots) */
 typedef struct _ksiginfo_t_
 {
 	siginfo_t  siginfo;
@@ -36,4 +23,37 @@ typedef struct _ksiginfo_t_
 }
 ksiginfo_t;
 
-#endif	/* _K_SIGNAL_C_ */
+/* descriptor for reading signals queued for thread (signalfd) */
+typedef struct _ksignalfd_t_
+{
+	sigset_t   mask;
+		   /* signals read through descriptor */
+	kthread_t *kthread;
+	id_t	   tid;
+		   /* thread whose queues are read (and its id) */
+	void	  *kdev;
+		   /* device that represents descriptor */
+	list_h	   list;
+		   /* in thread's list of signalfds */
+}
+ksignalfd_t;
+
+struct _ksignal_handling_t_
+{
+	sigset_t    *mask;
+		     /* addres of mask saved in thread state */
+	sigaction_t  act[SIGMAX + 1];
+
+	sigset_t     pending;
+		     /* signals with queued instances (deliverable when
+		      * pending & ~mask isn't empty) */
+	list_t	     queued[SIGMAX + 1];
+		     /* FIFO of ksiginfo_t for each signal; standard signals
+		      * (below SIGRTMIN) have at most one queued instance */
+	list_t	     free;
+	ksiginfo_t   slot[SIGQUEUE_MAX];
+		     /* preallocated elements for queues */
+
+	list_t	     signalfds;
+		     /* descriptors notified when signal is queued */
+};
@@ -6,6 +6,7 @@
 #include "syscall.h"
 #include "device.h"
 #include "memory.h"
+#include "interrupt.h"
 #include <kernel/errno.h>
 #include <kernel/features.h>
 #include <arch/interrupt.h>
@@ -24,25 +25,33 @@ uint kernel_features = FEATURE_SUPPORTED; /* initially set all to "on" state */
 void k_startup()
 {
 	extern void *k_stdout; /* console for kernel messages */
+	uint32 t[7]; /* processor cycles at boot phases */
+
+	t[0] = cpu_cycles();
 
 	/* set initial stdout */
 	kdevice_set_initial_stdout();
 
 	/* initialize memory subsystem (needed for boot) */
 	k_memory_init();
+	t[1] = cpu_cycles();
 
 	/*! start with regular initialization */
 
 	/* interrupts */
 	arch_init_interrupts();
+	k_interrupts_init();
 	arch_register_interrupt_handler(SOFTWARE_INTERRUPT, k_syscall, NULL);
 
 	/* detect memory faults (qemu do not detect segment violations!) */
 	arch_register_interrupt_handler(INT_MEM_FAULT, k_memory_fault, NULL);
 	arch_register_interrupt_handler(INT_UNDEF_FAULT, k_memory_fault, NULL);
+	arch_register_interrupt_handler(INT_PAGE_FAULT, k_memory_fault, NULL);
+	t[2] = cpu_cycles();
 
 	/* timer subsystem */
 	k_time_init();
+	t[3] = cpu_cycles();
 
 	/* devices */
 	k_devices_init();
@@ -51,16 +60,28 @@ void k_startup()
 	k_stdout = k_device_open(K_STDOUT, O_WRONLY);
 
 	kprintf("%s\n", system_info);
+	t[4] = cpu_cycles();
 
 	/* thread subsystem */
 	kthreads_init();
+	t[5] = cpu_cycles();
 
 	/* start inital program, defined in Makefile - create process */
 	if (!kthread_start_process(K_INIT_PROG, NULL, 0))
 	{
 		LOG(ERROR, "Cant start %s!", K_INIT_PROG);
+		kprint_flush();
 		halt();
 	}
+	t[6] = cpu_cycles();
+
+	/* boot phases duration (in thousands of processor cycles) */
+	if (t[0])
+		kprintf("Boot [kcycles]: memory=%d interrupts=%d time=%d "
+			"devices=%d threads=%d program=%d\n",
+			(t[1] - t[0]) / 1000, (t[2] - t[1]) / 1000,
+			(t[3] - t[2]) / 1000, (t[4] - t[3]) / 1000,
+			(t[5] - t[4]) / 1000, (t[6] - t[5]) / 1000);
 
 	/* complete initialization by starting first thread */
 	arch_return_to_thread();
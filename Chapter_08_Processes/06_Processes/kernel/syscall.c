@@ -24,6 +24,7 @@ static int(*k_sysfunc[SYSFUNCS])(void *params) =
 
 	sys__sysinfo,
 	sys__feature,
+	sys__brk,
 
 	sys__set_errno,
 	sys__get_errno,
@@ -75,9 +76,12 @@ static int(*k_sysfunc[SYSFUNCS])(void *params) =
 	sys__sigaction,
 	sys__pthread_sigmask,
 	sys__sigqueue,
-	sys__sigwaitinfo,
+	sys__sigtimedwait,
+	sys__signalfd,
+	sys__sigswitch,
 
-	sys__posix_spawn
+	sys__posix_spawn,
+	sys__waitpid
 };
 
 /*!
@@ -101,7 +105,8 @@ void k_syscall(uint irqn)
 
 	retval = k_sysfunc[id](params);
 
-	if (id != PTHREAD_EXIT)
+	/* thread state (context) is replaced in these calls */
+	if (id != PTHREAD_EXIT && id != SIGSWITCH)
 		arch_syscall_set_retval(context, retval);
 }
 
@@ -8,6 +8,8 @@
 #include "sched.h"
 #include <arch/processor.h>
 #include <arch/interrupt.h>
+#include <arch/paging.h>
+#include <arch/time.h>
 #include <arch/syscall.h>
 #include <types/bits.h>
 #include <lib/list.h>
@@ -21,7 +23,19 @@ static kthread_t *active_thread = NULL; /* active thread */
 kprocess_t kernel_proc; /* kernel process (currently only for idle thread) */
 static list_t kprocs; /* list of all processes */
 
+/*! descriptors of removed threads, kept for reuse (up to THREAD_CACHE_MAX) */
+static list_t thread_cache;
+static uint thread_cached = 0;
+
 static void kthread_remove_descriptor(kthread_t *kthread);
+static void kprocess_release(kprocess_t *kproc);
+static void kprocess_finish(kprocess_t *kproc);
+static void kpid_free(kpid_t *kpid);
+static void kthread_account_time();
+static void *kthread_stack_alloc(kprocess_t *kproc, size_t *size);
+static void kthread_stack_free(kprocess_t *kproc, void *stack, size_t size);
+
+static timespec_t active_since; /* when active thread was activated */
 /* idle thread */
 static void idle_thread(void *param);
 
@@ -31,14 +45,18 @@ void kthreads_init()
 {
 	list_init(&all_threads);
 	list_init(&kprocs);
+	list_init(&thread_cache);
+	thread_cached = 0;
 
 	active_thread = NULL;
 	ksched_init();
 
 	/* initially create 'idle thread' */
 	kernel_proc.proc = NULL;
-	kernel_proc.smap = NULL; /* use kernel pool */
-	kernel_proc.m.start = NULL;
+	kernel_proc.kprog = NULL;
+	kernel_proc.pid = NULL;
+	kernel_proc.main_thread = NULL;
+	kernel_proc.m.start = NULL; /* use kernel pool for stacks */
 	kernel_proc.m.size = (size_t) 0xffffffff;
 
 	(void) kthread_create(idle_thread, NULL, 0, SCHED_FIFO, 0, NULL,
@@ -58,74 +76,86 @@ void kthreads_init()
  */
 kthread_t *kthread_start_process(char *prog_name, void *param, int prio)
 {
-	extern list_t kprogs;
 	kprog_t *kprog;
-	kprocess_t *kproc;
+	kprocess_t *kproc, *warm;
 	process_t *proc;
 	kthread_t *kthread;
 	char **args = NULL, *arg, **kargs;
 	size_t argsize = 0;
-	int i, j;
-
-	kprog = list_get(&kprogs, FIRST);
-	while (kprog && strcmp(kprog->prog->name, prog_name))
-		kprog = list_get_next(&kprog->list);
+	int i;
 
+	kprog = k_find_program(prog_name);
 	if (!kprog)
 		return NULL;
 
-	/* create new process */
-	kproc = kmalloc(sizeof(kprocess_t));
+	/* reuse address space left by previous process of this program */
+	warm = kproc = list_remove(&kprog->warm, FIRST, NULL);
+	if (warm)
+		kprog->warm_count--;
+	else
+		kproc = kmalloc(sizeof(kprocess_t));
 	ASSERT(kproc);
 
 	strcpy(kproc->name, kprog->prog->name);
+	kproc->kprog = kprog;
 	kproc->heap_size = kprog->prog->heap_size;
 	kproc->stack_size = kprog->prog->stack_size;
 	kproc->thread_stack_size = kprog->prog->thread_stack;
 	kproc->prio = kprog->prog->prio;
 
-	kproc->m.size = kprog->m->size +
-			kproc->heap_size + kproc->stack_size;
-
-	kproc->m.start = kmalloc(kproc->m.size);
-	if (!kproc->m.start)
+	/* process memory: program, heap, thread stacks (from the end);
+	 * heap (brk) and stacks can grow up to PROC_MAX_SIZE */
+	if (!warm)
 	{
-		LOG(WARN, "Not enough memory for creating a new process!(%d)\n",
-		      kproc->m.size);
-		kfree(kproc);
-		return NULL;
+		kproc->m.start = NULL;
+		kproc->m.size = kprog->size +
+				kproc->heap_size + kproc->stack_size;
+		if (kproc->m.size < PROC_MAX_SIZE)
+			kproc->m.size = PROC_MAX_SIZE;
+
+		/* reserve address space and map program (text is shared);
+		 * other pages are committed on first access */
+		if (kprocess_memory_init(kproc) ||
+			kprocess_memory_load(kproc, kprog))
+		{
+			LOG(WARN, "Not enough memory for creating a new "
+				  "process!(%d)\n", kproc->m.size);
+			if (kproc->m.start)
+				kprocess_memory_free(kproc);
+			kfree(kproc);
+			return NULL;
+		}
 	}
-	kproc->m.type = MS_PROCESS;
-
-	/* copy code and data (memory segment with program) */
-	memcpy(kproc->m.start, kprog->m->start, kprog->m->size);
 
 	kproc->proc = (void *) kproc->m.start;
 	proc = kproc->proc;
 
-	/* define heap and stack */
-	kproc->heap = (void *) kproc->m.start + kprog->m->size;
-	kproc->stack = kproc->heap + kproc->heap_size;
-	memset(kproc->heap, 0, kproc->heap_size + kproc->stack_size);
-
-	/* initialize bitmap for threads stack management */
-	/* in stack area: kproc->smap_size thread stacks */
-	kproc->smap_size = kproc->stack_size / kproc->thread_stack_size;
-	ASSERT(kproc->smap_size > 0);
-
-	/* required number of uints for mask */
-	i = (kproc->smap_size + sizeof(uint)*8 - 1) /(sizeof(uint)*8);
-
-	kproc->smap = kmalloc(i * sizeof(uint));
-	memset(kproc->smap, 0, i * sizeof(uint));
-	for (j = kproc->smap_size%(sizeof(uint)*8+1); j < sizeof(uint)*8; j++)
-		kproc->smap[i-1] |= 1<<j;
+	/* define heap (zero filled when touched - no memset);
+	 * thread stacks are reserved when threads are created */
+	kproc->heap = (void *) kproc->m.start + kprog->size;
+	kproc->brk = kproc->heap + kproc->heap_size;
 
 	/* set addresses in process header to relative/logical addresses */
-	proc->heap = (void *) kprog->m->size;
-	proc->stack = proc->heap + proc->p.heap_size;
+	proc->heap = (void *) kprog->size;
+	proc->stack = (void *) kproc->m.size - PAGE_SIZE; /* stacks are below */
+	proc->clock = arch_clock_page() ? proc->stack : NULL;
 
 	kproc->thread_count = 0;
+	kproc->pages_max = kproc->pages;
+	TIME_RESET(&kproc->cpu_time);
+
+	/* process object, child of process that started it */
+	kproc->pid = kmalloc(sizeof(kpid_t));
+	ASSERT(kproc->pid);
+	kproc->pid->id = k_new_id(KTYPE_PROCESS, kproc->pid);
+	kproc->pid->kproc = kproc;
+	kproc->pid->parent = active_thread ? active_thread->proc->pid : NULL;
+	list_init(&kproc->pid->children);
+	kthreadq_init(&kproc->pid->wait_q);
+	kproc->pid->status = 0;
+	if (kproc->pid->parent)
+		list_append(&kproc->pid->parent->children, kproc->pid,
+			     &kproc->pid->list);
 
 	if (!prio)
 		prio = kproc->prio;
@@ -151,7 +181,8 @@ kthread_t *kthread_start_process(char *prog_name, void *param, int prio)
 			  - (size_t) param;
 		/* look in sys__posix_spawn for argument packing */
 
-		if (argsize > 0)
+		if (argsize > 0 &&
+			!k_memory_commit(kproc, kproc->heap, argsize))
 		{
 			args = kproc->heap; /* pointers at start */
 			proc->heap += argsize; proc->p.heap_size -= argsize;
@@ -173,6 +204,7 @@ kthread_t *kthread_start_process(char *prog_name, void *param, int prio)
 	}
 	kthread = kthread_create(kproc->proc->p.init, args, 0, SCHED_FIFO,
 				   prio, NULL, 0, kproc);
+	kproc->main_thread = kthread;
 
 	list_append(&kprocs, kproc, &kproc->list);
 
@@ -199,13 +231,18 @@ kthread_t *kthread_create(void *start_routine, void *arg, uint flags,
 	ASSERT(proc);
 
 	kthread_t *kthread;
+	int i;
 
-	/* thread descriptor */
-	kthread = kmalloc(sizeof(kthread_t));
+	/* thread descriptor (from cache, if there is one) */
+	kthread = list_remove(&thread_cache, FIRST, NULL);
+	if (kthread)
+		thread_cached--;
+	else
+		kthread = kmalloc(sizeof(kthread_t));
 	ASSERT(kthread);
 
 	/* initialize thread descriptor */
-	kthread->id = k_new_id();
+	kthread->id = k_new_id(KTYPE_THREAD, kthread);
 
 	kthread->proc = proc;
 	kthread->proc->thread_count++;
@@ -213,6 +250,10 @@ kthread_t *kthread_create(void *start_routine, void *arg, uint flags,
 	kthread->queue = NULL;
 	kthreadq_init(&kthread->join_queue);
 
+	kthread->nested = 0;
+	for (i = 0; i < HANDLER_NEST_MAX; i++)
+		kthread->nest[i].stack = NULL;
+
 	kthread_create_new_state(kthread, start_routine, arg,
 				   stackaddr, stacksize, FALSE);
 	kthread->state.flags = flags;
@@ -252,7 +293,14 @@ void kthread_create_new_state(kthread_t *kthread,
 	/* save old state if requested (put it at beginning of state list) */
 	if (save_old_state)
 	{
-		kthread_state_t *state = kmalloc(sizeof(kthread_state_t));
+		kthread_state_t *state;
+
+		if (kthread->nested < HANDLER_NEST_MAX)
+			state = &kthread->nest[kthread->nested].state;
+		else
+			state = kmalloc(sizeof(kthread_state_t));
+		kthread->nested++;
+
 		*state = kthread->state;
 		list_prepend(&kthread->states, state, &state->list);
 	}
@@ -263,18 +311,8 @@ void kthread_create_new_state(kthread_t *kthread,
 	{
 		stack_provided = TRUE;
 	}
-	else if (kproc->smap)
-	{
-		/* use process stack heap */
-		stack_size = kproc->thread_stack_size;
-		stack = kprocess_stack_alloc(kproc);
-	}
 	else {
-		/* use kernel heap */
-		if (!stack_size)
-			stack_size = DEFAULT_THREAD_STACK_SIZE;
-
-		stack = kmalloc(stack_size);
+		stack = kthread_stack_alloc(kproc, &stack_size);
 	}
 	ASSERT(stack && stack_size);
 
@@ -288,9 +326,14 @@ void kthread_create_new_state(kthread_t *kthread,
 		kthread->state.stack_size = stack_size;
 	}
 
+	/* kernel writes errno and initial frame on top of new stack */
+	if (k_memory_commit(kproc, stack + stack_size - STACK_TOP_COMMIT,
+			      STACK_TOP_COMMIT))
+		LOG(ERROR, "No memory for thread stack!");
+
 	/* reserve space for errno in user space */
 	stack_size -= sizeof(int);
-	kthread->state.errno = kthread->state.stack + stack_size;
+	kthread->state.errno = stack + stack_size;
 
 	arch_create_thread_context(&kthread->state.context, start_func, param,
 				     kproc->proc->p.exit, stack, stack_size, kproc);
@@ -302,6 +345,97 @@ void kthread_create_new_state(kthread_t *kthread,
 	list_init(&kthread->state.cleanup);
 }
 
+/*!
+ * Create state for signal handler: current state is saved in preallocated
+ * slot and handler runs on stack of that slot (both are kept for next
+ * handler on same nesting level; deeper levels allocate them)
+ * \param kthread Thread
+ * \param start_func Handler
+ * \param data Handler parameter, copied on top of handler stack
+ * \param size Parameter size
+ * \return EXIT_SUCCESS, ENOMEM if handler stack can't be allocated
+ */
+int kthread_create_handler_state(kthread_t *kthread, void *start_func,
+				   void *data, size_t size)
+{
+	kprocess_t *kproc;
+	kthread_nest_t *nest = NULL;
+	size_t stack_size = HANDLER_STACK_SIZE, top;
+	void *stack, *param;
+
+	ASSERT(kthread && data);
+	kproc = kthread_get_process(kthread);
+	ASSERT(kproc);
+
+	if (kthread->nested < HANDLER_NEST_MAX)
+	{
+		nest = &kthread->nest[kthread->nested];
+		if (!nest->stack)
+		{
+			nest->stack_size = HANDLER_STACK_SIZE;
+			nest->stack = kthread_stack_alloc(kproc,
+							    &nest->stack_size);
+		}
+		stack = nest->stack;
+		stack_size = nest->stack_size;
+	}
+	else {
+		stack = kthread_stack_alloc(kproc, &stack_size);
+	}
+	if (!stack)
+		return ENOMEM;
+
+	/* parameter is above errno and initial frame */
+	top = (size + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1);
+	if (k_memory_commit(kproc, stack + stack_size - top - STACK_TOP_COMMIT,
+			      top + STACK_TOP_COMMIT))
+	{
+		if (!nest)
+			kthread_stack_free(kproc, stack, stack_size);
+		return ENOMEM;
+	}
+
+	param = stack + stack_size - top;
+	memcpy(param, data, size);
+
+	kthread_create_new_state(kthread, start_func, K2U_GET_ADR(param, kproc),
+				   stack, stack_size - top, TRUE);
+
+	/* stack not from slot is released with state */
+	if (!nest)
+	{
+		kthread->state.stack = stack;
+		kthread->state.stack_size = stack_size;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/*! Reserve thread stack: in process (committed when used) or kernel heap */
+static void *kthread_stack_alloc(kprocess_t *kproc, size_t *size)
+{
+	if (kproc->m.start)
+	{
+		if (!*size)
+			*size = kproc->thread_stack_size;
+
+		return kprocess_stack_alloc(kproc, size);
+	}
+
+	if (!*size)
+		*size = DEFAULT_THREAD_STACK_SIZE;
+
+	return kmalloc(*size);
+}
+
+static void kthread_stack_free(kprocess_t *kproc, void *stack, size_t size)
+{
+	if (kproc->m.start)
+		kprocess_stack_free(kproc, stack, size);
+	else
+		kfree(stack); /* kernel level thread */
+}
+
 /*! restore previously saved state (last saved) */
 int kthread_restore_state(kthread_t *kthread)
 {
@@ -318,14 +452,8 @@ int kthread_restore_state(kthread_t *kthread)
 
 	/* release thread stack */
 	if (kthread->state.stack)
-	{
-		if (kthread->proc->smap && kthread->state.stack)
-			kprocess_stack_free(kthread->proc,
-					      kthread->state.stack);
-
-		else if (kthread->state.stack) /* kernel level thread */
-			kfree(kthread->state.stack);
-	}
+		kthread_stack_free(kthread->proc, kthread->state.stack,
+				     kthread->state.stack_size);
 
 	int retval = FALSE;
 
@@ -334,7 +462,9 @@ int kthread_restore_state(kthread_t *kthread)
 	if (state)
 	{
 		kthread->state = *state;
-		kfree(state);
+		kthread->nested--;
+		if (kthread->nested >= HANDLER_NEST_MAX)
+			kfree(state); /* not from preallocated slot */
 		retval = TRUE;
 	}
 
@@ -420,6 +550,7 @@ int kthread_exit(kthread_t *kthread, void *exit_status, int force)
 	kthread_t *released;
 	kthread_q *q;
 	void **p;
+	int i;
 
 	ASSERT(kthread);
 
@@ -476,24 +607,44 @@ int kthread_exit(kthread_t *kthread, void *exit_status, int force)
 	kthread->state.exit_status = exit_status;
 	kthread->proc->thread_count--;
 
+	if (kthread == kthread->proc->main_thread)
+	{
+		/* process exit status is first thread exit status */
+		if (kthread->proc->pid)
+			kthread->proc->pid->status = (int) exit_status;
+		kthread->proc->main_thread = NULL;
+	}
+
+	if (kthread == active_thread)
+		kthread_account_time(); /* include last time slice */
+
 	arch_destroy_thread_context(&kthread->state.context);
 
 	kthread_restore_state(kthread);
 
+	/* stacks kept for signal handlers */
+	for (i = 0; i < HANDLER_NEST_MAX; i++)
+	{
+		if (kthread->nest[i].stack)
+			kthread_stack_free(kthread->proc, kthread->nest[i].stack,
+					     kthread->nest[i].stack_size);
+		kthread->nest[i].stack = NULL;
+	}
+
 	if (kthread->proc->thread_count == 0 && kthread->proc)
 	{
 		/* last (non-kernel) thread - remove process */
 
 		kfree_process_kobjects(kthread->proc);
+		kprocess_finish(kthread->proc);
 
-		kfree(kthread->proc->m.start);
 #ifdef DEBUG
 		ASSERT(kthread->proc ==
 			list_find_and_remove(&kprocs, &kthread->proc->list));
 #else
 		(void) list_remove(&kprocs, 0, &kthread->proc->list);
 #endif
-		kfree(kthread->proc);
+		kprocess_release(kthread->proc);
 		kthread->proc = NULL;
 	}
 
@@ -523,6 +674,215 @@ int kthread_exit(kthread_t *kthread, void *exit_status, int force)
 	return EXIT_SUCCESS;
 }
 
+/*! Add time since last activation to active thread process */
+static void kthread_account_time()
+{
+	timespec_t now, used;
+
+	arch_get_time(&now);
+
+	if (active_thread && active_thread->proc)
+	{
+		used = now;
+		time_sub(&used, &active_since);
+		time_add(&active_thread->proc->cpu_time, &used);
+	}
+
+	active_since = now;
+}
+
+/*!
+ * Last thread of process finished: save used resources in process object
+ * and pass it to parent (or free it, if there is no parent); children of
+ * finished process lose their parent
+ */
+static void kprocess_finish(kprocess_t *kproc)
+{
+	kpid_t *kpid = kproc->pid, *child;
+	kthread_t *kthread;
+	void *p;
+	int retval, n;
+
+	if (!kpid)
+		return;
+
+	kproc->pid = NULL;
+	kpid->kproc = NULL;
+	kpid->usage.ru_utime = kproc->cpu_time;
+	kpid->usage.ru_maxrss = kproc->pages_max * (PAGE_SIZE / 1024);
+
+	while ((child = list_remove(&kpid->children, FIRST, NULL)))
+	{
+		child->parent = NULL;
+		if (!child->kproc)
+			kpid_free(child); /* finished, never collected */
+	}
+
+	if (!kpid->parent)
+	{
+		kpid_free(kpid);
+		return;
+	}
+
+	/* let parent threads blocked in waitpid retry (those that still have
+	 * nothing to collect are put back in queue) */
+	n = 0;
+	kthread = kthreadq_get(&kpid->parent->wait_q);
+	for (; kthread; kthread = kthreadq_get_next(kthread))
+		n++;
+
+	while (n-- > 0)
+	{
+		kthread = kthreadq_remove(&kpid->parent->wait_q, NULL);
+		p = arch_syscall_get_params(kthread_get_context(kthread));
+
+		retval = kprocess_wait(p, kthread);
+		if (retval == -EAGAIN)
+			continue; /* blocked again */
+
+		if (retval >= 0)
+		{
+			kthread_set_errno(kthread, EXIT_SUCCESS);
+			kthread_set_syscall_retval(kthread, retval);
+		}
+		else {
+			kthread_set_errno(kthread, -retval);
+			kthread_set_syscall_retval(kthread, EXIT_FAILURE);
+		}
+		kthread_move_to_ready(kthread, LAST);
+	}
+}
+
+/*! Release process object */
+static void kpid_free(kpid_t *kpid)
+{
+	k_free_id(kpid->id);
+	kfree(kpid);
+}
+
+/*!
+ * Wait for child process to finish
+ * \param p Parameters as for waitpid/wait4 (pid, status, options, usage)
+ * \param kthread Thread calling waitpid (active or one being retried)
+ * \return 0 if child is collected (or none finished and WNOHANG is set),
+ *         -EAGAIN if thread is blocked, -errno on error
+ */
+int kprocess_wait(void *p, kthread_t *kthread)
+{
+	pid_t *pid;
+	int *status;
+	int options;
+	rusage_t *usage;
+
+	kprocess_t *kproc = kthread_get_process(kthread);
+	kpid_t *kpid = kproc->pid, *child;
+
+	pid =		*((pid_t **) p);	p += sizeof(pid_t *);
+	status =	*((int **) p);		p += sizeof(int *);
+	options =	*((int *) p);		p += sizeof(int);
+	usage =		*((rusage_t **) p);
+
+	ASSERT_ERRNO_AND_EXIT(pid, -EINVAL);
+	pid = U2K_GET_ADR(pid, kproc);
+	if (status)
+		status = U2K_GET_ADR(status, kproc);
+	if (usage)
+		usage = U2K_GET_ADR(usage, kproc);
+
+	if (k_memory_commit(kproc, pid, sizeof(pid_t)) ||
+		(status && k_memory_commit(kproc, status, sizeof(int))) ||
+		(usage && k_memory_commit(kproc, usage, sizeof(rusage_t))))
+		return -ENOMEM;
+
+	if (!kpid || !list_get(&kpid->children, FIRST))
+		return -ECHILD;
+
+	if (pid->ptr)
+	{
+		/* given child */
+		child = pid->ptr;
+		if (k_id_object(pid->id, KTYPE_PROCESS) != child ||
+			child->parent != kpid)
+			return -ECHILD;
+		if (child->kproc)
+			child = NULL; /* not finished yet */
+	}
+	else {
+		/* any finished child */
+		child = list_get(&kpid->children, FIRST);
+		while (child && child->kproc)
+			child = list_get_next(&child->list);
+	}
+
+	if (!child)
+	{
+		if (!(options & WNOHANG))
+		{
+			kthread_enqueue(kthread, &kpid->wait_q, 1, NULL, NULL);
+			return -EAGAIN;
+		}
+
+		pid->ptr = NULL;
+		pid->id = 0;
+		return EXIT_SUCCESS;
+	}
+
+	pid->ptr = child;
+	pid->id = child->id;
+	if (status)
+		*status = child->status;
+	if (usage)
+		*usage = child->usage;
+
+	(void) list_remove(&kpid->children, 0, &child->list);
+	kpid_free(child);
+
+	return EXIT_SUCCESS;
+}
+
+/*! Get process id (for process descriptor in user space) */
+void kprocess_get_pid(kprocess_t *kproc, pid_t *pid)
+{
+	pid->ptr = kproc->pid;
+	pid->id = kproc->pid ? kproc->pid->id : 0;
+}
+
+/*!
+ * Get main thread of process given with process id (from user space)
+ * \return thread descriptor, NULL if process or its main thread is gone
+ */
+kthread_t *kprocess_main_thread(pid_t *pid)
+{
+	kpid_t *kpid;
+
+	if (!pid->ptr || (kpid = k_id_object(pid->id, KTYPE_PROCESS)) !=
+		pid->ptr || !kpid->kproc)
+		return NULL;
+
+	return kpid->kproc->main_thread;
+}
+
+/*!
+ * Release memory of finished process: keep up to PROC_CACHE_MAX address
+ * spaces per program (reset to initial state) for next start of the same
+ * program, free others
+ */
+static void kprocess_release(kprocess_t *kproc)
+{
+	kprog_t *kprog = kproc->kprog;
+
+	if (kprog && kprog->warm_count < PROC_CACHE_MAX &&
+		!kprocess_memory_reset(kproc, kprog))
+	{
+		list_append(&kprog->warm, kproc, &kproc->list);
+		kprog->warm_count++;
+	}
+	else {
+		kprocess_memory_free(kproc);
+		kfree(kproc);
+	}
+}
+
 /*! Internal function for removing (freeing) thread descriptor */
 static void kthread_remove_descriptor(kthread_t *kthread)
 {
@@ -537,7 +897,16 @@ static void kthread_remove_descriptor(kthread_t *kthread)
 	(void) list_remove(&all_threads, 0, &kthread->all);
 #endif
 
-	kfree(kthread);
+	/* keep descriptor for next thread (it may get the same address, so
+	 * references kept by kernel are checked with thread id) */
+	if (thread_cached < THREAD_CACHE_MAX)
+	{
+		list_append(&thread_cache, kthread, &kthread->all);
+		thread_cached++;
+	}
+	else {
+		kfree(kthread);
+	}
 }
 
 /*!
@@ -781,10 +1150,10 @@ int kthread_is_suspended(kthread_t *kthread, void **func, void **param)
 		return FALSE;
 }
 
-/*! check if thread descriptor is valid, i.e. is in all thread list */
+/*! check if thread descriptor is valid, i.e. registered with its id */
 int kthread_check_kthread(kthread_t *kthread)
 {
-	return kthread && list_find(&all_threads, &kthread->all);
+	return kthread && k_id_object(kthread->id, KTYPE_THREAD) == kthread;
 }
 
 int kthread_get_id(kthread_t *kthread)
@@ -808,6 +1177,21 @@ void *kthread_get_context(kthread_t *kthread)
 		return &active_thread->state.context;
 }
 
+/*! Context interrupted by signal handler (NULL if handler isn't running) */
+void *kthread_get_interrupted_context(kthread_t *kthread)
+{
+	kthread_state_t *state;
+
+	if (!kthread)
+		kthread = active_thread;
+
+	state = list_get(&kthread->states, FIRST);
+	if (state)
+		return &state->context;
+	else
+		return NULL;
+}
+
 void *kthread_get_process(kthread_t *kthread)
 {
 	if (kthread)
@@ -816,13 +1200,16 @@ void *kthread_get_process(kthread_t *kthread)
 		return active_thread->proc;
 }
 
-/*! Get kernel thread descriptor from user thread descriptor */
+/*!
+ * Get kernel thread descriptor from user thread descriptor
+ * (pointer from user is used only if registered with given id)
+ */
 kthread_t *kthread_get_descriptor(pthread_t *thread)
 {
 	kthread_t *kthread;
 
-	if (thread && (kthread = thread->ptr) && thread->id == kthread->id &&
-		kthread->state.state != THR_STATE_PASSIVE)
+	if (thread && thread->ptr &&
+		(kthread = k_id_object(thread->id, KTYPE_THREAD)) == thread->ptr)
 		return kthread;
 	else
 		return NULL;
@@ -847,6 +1234,8 @@ int kthread_get_interruptable(kthread_t *kthread)
 void kthread_set_active(kthread_t *kthread)
 {
 	ASSERT(kthread);
+	if (kthread != active_thread)
+		kthread_account_time();
 	active_thread = kthread;
 	active_thread->state.state = THR_STATE_ACTIVE;
 	active_thread->queue = NULL;
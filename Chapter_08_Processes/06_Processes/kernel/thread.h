@@ -28,6 +28,8 @@ kthread_t *kthread_create(void *start_routine, void *arg, uint flags,
 /*! insert/restore state for signal handler and similar */
 void kthread_create_new_state(kthread_t *kthread, void *start_func,
 	void *param, void *stack, size_t stack_size, int save_old_state);
+int kthread_create_handler_state(kthread_t *kthread, void *start_func,
+				   void *data, size_t size);
 int kthread_restore_state(kthread_t *kthread);
 
 /*! suspend thread on delay and wait for signal */
@@ -46,6 +48,11 @@ int kthread_exit(kthread_t *kthread, void *exit_status, int force);
 void kthread_wait_thread(kthread_t *waiting, kthread_t *waited);
 void kthread_collect_status(kthread_t *waited, void **retval);
 
+/*! wait for child process to finish (parameters as for waitpid) */
+int kprocess_wait(void *p, kthread_t *kthread);
+void kprocess_get_pid(kprocess_t *kproc, pid_t *pid);
+kthread_t *kprocess_main_thread(pid_t *pid);
+
 /*! Thread queue manipulation - advanced operations */
 void kthread_enqueue(kthread_t *kthread, kthread_q *q_id, int sig_int,
 		       void *wakeup_action, void *param);
@@ -82,6 +89,7 @@ int kthread_check_kthread(kthread_t *kthread);
 int kthread_get_id(kthread_t *kthread);
 kthread_t *kthread_get_active();
 void *kthread_get_context(kthread_t *thread);
+void *kthread_get_interrupted_context(kthread_t *kthread);
 void *kthread_get_process(kthread_t *kthread);
 kthread_t *kthread_get_descriptor(pthread_t *thr);
 
@@ -172,6 +180,18 @@ typedef struct _kthread_state_cleanup_t_
 }
 kthread_state_cleanup_t;
 
+/*! Preallocated slot for one nesting level of signal handlers */
+typedef struct _kthread_nest_t_
+{
+	kthread_state_t  state;
+			 /* interrupted state, saved while handler runs */
+
+	void		*stack;
+	size_t		 stack_size;
+			 /* handler stack (kept for next handler on this level) */
+}
+kthread_nest_t;
+
 
 /*! Thread descriptor */
 struct _kthread_t_
@@ -186,6 +206,10 @@ struct _kthread_t_
 			    /* thread state, context, ... */
 	list_t		    states;
 			    /* previously saved states */
+	kthread_nest_t	    nest[HANDLER_NEST_MAX];
+	int		    nested;
+			    /* number of saved states; first HANDLER_NEST_MAX
+			     * are in 'nest', deeper ones are allocated */
 
 	int		    sched_policy;
 			    /* scheduling policy */
@@ -211,6 +235,35 @@ struct _kthread_t_
 			    /* reference counter */
 };
 
+/*! Process object: exists from process start until parent collects its
+ *  exit status (or while parent exists, if it never does) */
+struct _kpid_t_
+{
+	id_t		    id;
+			    /* process id (number) */
+
+	kprocess_t	   *kproc;
+			    /* process; NULL when it is finished */
+
+	kpid_t		   *parent;
+			    /* parent process; NULL if finished or none */
+
+	list_t		    children;
+			    /* child processes (kpid_t) */
+
+	kthread_q	    wait_q;
+			    /* parent threads blocked in waitpid */
+
+	int		    status;
+			    /* exit status (of first thread) */
+
+	rusage_t	    usage;
+			    /* used resources (when finished) */
+
+	list_h		    list;
+			    /* list element for parent's list of children */
+};
+
 /*! Thread states */
 enum {
 	THR_STATE_ACTIVE = 1,
@@ -70,18 +70,17 @@ int kclock_settime(clockid_t clockid, timespec_t *time)
 
 /*!
  * Resume suspended thread (called on timer activation)
- * \param sigval Thread that should be released
+ * \param sigval Id of thread that should be released
  */
 static void kclock_wake_thread(sigval_t sigval)
 {
 	kthread_t *kthread;
 	ktimer_t *ktimer;
 
-	kthread = sigval.sival_ptr;
-	ASSERT(kthread);
+	/* thread is given with id: its descriptor could be reused */
+	kthread = k_id_object(sigval.sival_int, KTYPE_THREAD);
 
-	if (kthread_check_kthread(kthread) &&
-		kthread_is_suspended(kthread, NULL, NULL))
+	if (kthread && kthread_is_suspended(kthread, NULL, NULL))
 	{
 		ktimer = kthread_get_private_param(kthread);
 		timespec_t *remain = ktimer->param;
@@ -156,7 +155,7 @@ static int ktimer_cmp(void *_a, void *_b)
  * \param clockid	Clock used in timer
  * \param evp		Timer expiration action
  * \param ktimer	Timer descriptor address is returned here
- * \param owner		Timer owner: thread descriptor or NULL if kernel timer
+ * \return status	0 for success, ENOMEM if there is no memory for timer
  * \return status	0 for success
  */
 int ktimer_create(clockid_t clockid, sigevent_t *evp, ktimer_t **_ktimer,
@@ -168,12 +167,14 @@ int ktimer_create(clockid_t clockid, sigevent_t *evp, ktimer_t **_ktimer,
 	/* add other checks on evp if required */
 
 	ktimer = kmalloc(sizeof(ktimer_t));
-	ASSERT(ktimer);
+	if (!ktimer)
+		return ENOMEM;
 
-	ktimer->id = k_new_id();
+	ktimer->id = k_new_id(KTYPE_TIMER, ktimer);
 	ktimer->clockid = clockid;
 	ktimer->evp = *evp;
 	ktimer->owner = owner;
+	ktimer->owner_id = owner ? kthread_get_id(owner) : 0;
 	TIMER_DISARM(ktimer);
 	ktimer->param = NULL;
 
@@ -333,8 +334,10 @@ static void ktimer_schedule()
 						first->evp.sigev_value
 					);
 			}
-			else {
-				/* timer set by thread */
+			else if (k_id_object(first->owner_id, KTYPE_THREAD) ==
+				 first->owner)
+			{
+				/* timer set by thread (still existing) */
 				if (!ksignal_process_event(
 					&first->evp, first->owner, SI_TIMER))
 				{
@@ -386,6 +389,9 @@ int sys__clock_gettime(void *p)
 	);
 	time =  U2K_GET_ADR(time, kthread_get_process(NULL));
 	ASSERT_ERRNO_AND_EXIT(time, EINVAL);
+	if (k_memory_commit(kthread_get_process(NULL), time,
+			      sizeof(timespec_t)))
+		EXIT(ENOMEM);
 
 	retval = kclock_gettime(clockid, time);
 
@@ -455,22 +461,27 @@ int sys__clock_nanosleep(void *p)
 	ASSERT_ERRNO_AND_EXIT(request, EINVAL);
 	ASSERT_ERRNO_AND_EXIT(TIME_IS_SET(request), EINVAL);
 
+	if (remain)
+	{
+		remain =  U2K_GET_ADR(remain, kthread_get_process(NULL));
+		if (k_memory_commit(kthread_get_process(NULL), remain,
+				      sizeof(timespec_t)))
+			EXIT(ENOMEM);
+	}
+
 	/* Timers are used for "sleep" operations through steps 1-4 */
 
 	/* 1. create timer, but not arm it yet */
 	evp.sigev_notify = SIGEV_WAKE_THREAD;
-	evp.sigev_value.sival_ptr = kthread;
+	evp.sigev_value.sival_int = kthread_get_id(kthread);
 	evp.sigev_notify_function = kclock_wake_thread;
 
-	retval += ktimer_create(clockid, &evp, &ktimer, kthread);
-	ASSERT(retval == EXIT_SUCCESS);
+	if (ktimer_create(clockid, &evp, &ktimer, kthread))
+		EXIT(ENOMEM);
 
 	/* save remainder location, if provided */
 	if (remain)
-	{
-		remain =  U2K_GET_ADR(remain, kthread_get_process(NULL));
 		ktimer->param = remain;
-	}
 
 	/* 2. suspend thread */
 	kthread_set_private_param(kthread, ktimer);
@@ -519,6 +530,8 @@ int sys__timer_create(void *p)
 	evp = U2K_GET_ADR(evp, proc);
 	timerid = U2K_GET_ADR(timerid, proc);
 	ASSERT_ERRNO_AND_EXIT(evp && timerid, EINVAL);
+	if (k_memory_commit(proc, timerid, sizeof(timer_t)))
+		EXIT(ENOMEM);
 
 	retval = ktimer_create(clockid, evp, &ktimer, kthread_get_active());
 	if (retval == EXIT_SUCCESS)
@@ -605,7 +618,12 @@ int sys__timer_settime(void *p)
 	ASSERT_ERRNO_AND_EXIT(ktimer && ktimer->id == timerid->id, EINVAL);
 
 	value = U2K_GET_ADR(value, proc);
-	ovalue = U2K_GET_ADR(ovalue, proc);
+	if (ovalue)
+	{
+		ovalue = U2K_GET_ADR(ovalue, proc);
+		if (k_memory_commit(proc, ovalue, sizeof(itimerspec_t)))
+			EXIT(ENOMEM);
+	}
 
 	retval = ktimer_settime(ktimer, flags, value, ovalue);
 
@@ -645,6 +663,8 @@ int sys__timer_gettime(void *p)
 	ASSERT_ERRNO_AND_EXIT(ktimer && ktimer->id == timerid->id, EINVAL);
 
 	value = U2K_GET_ADR(value, proc);
+	if (k_memory_commit(proc, value, sizeof(itimerspec_t)))
+		EXIT(ENOMEM);
 
 	retval = ktimer_gettime(ktimer, value);
 
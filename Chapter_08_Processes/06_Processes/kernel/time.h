@@ -44,7 +44,9 @@ struct _ktimer_t_
 	itimerspec_t  itimer;
 		      /* interval timers {it_value, it_interval} */
 	void	     *owner;
-		      /* owner threads or NULL if kernel timer */
+	id_t	      owner_id;
+		      /* owner thread or NULL if kernel timer (with its id,
+		       * since descriptor of exited thread may be reused) */
 
 	void	     *param;
 		      /* additional parameter (remainder for sleep)*/
@@ -49,7 +49,14 @@ gma_t *gma_init(void *memory_segment, size_t size, size_t min_chunk_size,
 
 	mpool->fl_min = msb_index(mpool->min_chunk_size);
 
-	mpool->fl_max = msb_index(size);
+	/* extendable pool must have lists for chunks of any size */
+	if (flags & GMA_EXTENDABLE)
+		mpool->fl_max = msb_index(MAX_CHUNK_SIZE);
+	else
+		mpool->fl_max = msb_index(size);
+
+	mpool->flags = flags;
+	mpool->end = end;
 
 	levels = mpool->fl_max - mpool->fl_min + 1;
 
@@ -64,12 +71,6 @@ gma_t *gma_init(void *memory_segment, size_t size, size_t min_chunk_size,
 		for (j = 0; j < SL_DIM; j++)
 			mpool->chunk[i][j] = NULL;
 
-	/*
-	 * for 'extend' and 'shrink' operations
-	 * mpool->pool = memory_segment;
-	 * mpool->size = size;
-	 */
-
 	/* Create first chunk that occupy whole usable area  */
 	chunk = make_first_chunk((void *) addr, end - addr);
 
@@ -79,6 +80,55 @@ gma_t *gma_init(void *memory_segment, size_t size, size_t min_chunk_size,
 	return mpool;
 }
 
+/*!
+ * Add memory segment to pool (pool must be created with GMA_EXTENDABLE)
+ * \param mpool Memory pool pointer, or NULL (for default)
+ * \param memory_segment Segment start address
+ * \param size Segment size
+ * \return 0 if successful, -1 otherwise
+ */
+int gma_add_segment(gma_t *mpool, void *memory_segment, size_t size)
+{
+	size_t addr, end;
+	mchunk_t *chunk, *border;
+
+	if (mpool == NULL)
+		mpool = &pool;
+
+	if (!(mpool->flags & GMA_EXTENDABLE) || !memory_segment)
+		return EXIT_FAILURE;
+
+	addr = CHUNK_ALIGN_FW(memory_segment);
+	end = CHUNK_ALIGN(memory_segment + size);
+
+	if (addr == mpool->end && end - addr >= MIN_CHUNK_SIZE)
+	{
+		/* segment continues on last one: border chunk at the end of
+		 * last segment becomes start of new chunk */
+		chunk = GET_CHUNK_HDR_FROM_USABLE_ADDR(addr);
+		SET_CHUNK_SIZE(chunk, end - addr); /* B, C bits preserved */
+
+		border = GET_CHUNK_AFTER(chunk);
+		SET_BORDER_CHUNK(border);
+		SET_CHUNK_BINUSE(border);
+
+		chunk = GET_CHUNK_USABLE_ADDR(chunk);
+	}
+	else if (end > addr && end - addr > BORDER_CHUNK_SIZE * 2 +
+		   MIN_CHUNK_SIZE)
+	{
+		chunk = make_first_chunk((void *) addr, end - addr);
+	}
+	else {
+		return EXIT_FAILURE;
+	}
+
+	mpool->end = end;
+
+	/* "free" chunk (merged with free chunk before, if there is one) */
+	return gma_free(mpool, chunk);
+}
+
 /*!
  * Memory allocation for chunk of size 'size'
  * \param mpool Memory pool pointer, or NULL (for default)
@@ -0,0 +1,91 @@
+/*! Asynchronous tasks example */
+
+#include <async.h>
+
+#include <stdio.h>
+
+char PROG_HELP[] = "Tasks without own stacks, run from single event loop: "
+		   "three timers and keyboard reader (press '.' to end).";
+
+typedef struct _ticker_t_
+{
+	async_t task;
+	int id, period, count;
+}
+ticker_t;
+
+static int ticker(async_t *task)
+{
+	ticker_t *t = task->param;
+
+	ASYNC_BEGIN(task);
+
+	for (t->count = 0; t->count < 5; t->count++)
+	{
+		ASYNC_SLEEP(task, t->period);
+		printf("Ticker %d: tick %d\n", t->id, t->count);
+	}
+
+	ASYNC_RETURN(task, t->id);
+
+	ASYNC_END(task);
+}
+
+static int reader(async_t *task)
+{
+	int key;
+
+	ASYNC_BEGIN(task);
+
+	for (;;)
+	{
+		ASYNC_AWAIT_FD(task, 0, POLLIN, 5000);
+		if (!task->result)
+		{
+			printf("Reader: no key in last 5 s\n");
+			continue;
+		}
+
+		key = getchar();
+		printf("Reader: got %c(%d)\n", key, key);
+		if (key == '.')
+			break;
+	}
+
+	ASYNC_END(task);
+}
+
+static void finished(async_t *task)
+{
+	printf("Task finished, retval=%d\n", task->retval);
+}
+
+int async_io(char *args[])
+{
+	async_loop_t loop;
+	ticker_t tickers[3];
+	async_t keyboard;
+	int i;
+
+	printf("Example program: [%s:%s]\n%s\n\n", __FILE__, __FUNCTION__,
+		 PROG_HELP);
+
+	if (async_loop_init(&loop, 8, 2))
+		return -1;
+
+	for (i = 0; i < 3; i++)
+	{
+		tickers[i].id = i + 1;
+		tickers[i].period = 300 * (i + 1);
+		async_start(&loop, &tickers[i].task, ticker, &tickers[i],
+			      finished);
+	}
+	async_start(&loop, &keyboard, reader, NULL, finished);
+
+	async_run(&loop);
+	async_loop_destroy(&loop);
+
+	printf("All tasks finished\n");
+
+	return 0;
+}
@@ -13,8 +13,9 @@ char PROG_HELP[] = "Run all compiled programs";
 
 int run_all(char *args[])
 {
-	pthread_t thr;
-	int *status, rv;
+	pid_t thr;
+	int status, rv;
+	rusage_t usage;
 	char *progname;
 
 #if 0	/* run all programs */
@@ -48,25 +49,19 @@ int run_all(char *args[])
 		rv = posix_spawn(&thr, progname, NULL, NULL, NULL, NULL);
 		if (!rv)
 		{
-			rv = pthread_join(thr, (void **) &status);
-			if (rv && get_errno() != ESRCH)
+			rv = wait4(&thr, &status, 0, &usage);
+			if (rv)
 			{
-				printf("\npthread_join error!\n\n");
+				printf("\nwaitpid error!\n\n");
 				break;
 			}
-#if 0
-			/* most functions do not call pthread_exit directly so
-			 * the following test might be "false negative" */
-			else if (status && *status)
-			{
-				printf("\nProgram %s exited with error!\n\n",
-					 progname);
-				break;
-			}
-#endif
 			else {
-				printf("\nProgram %s exited successfully!\n\n",
-					progname);
+				printf("\nProgram %s exited with status %d "
+					"(cpu time %d ms, memory %d kB)\n\n",
+					progname, status,
+					usage.ru_utime.tv_sec * 1000 +
+					usage.ru_utime.tv_nsec / 1000000,
+					usage.ru_maxrss);
 			}
 		}
 		else {
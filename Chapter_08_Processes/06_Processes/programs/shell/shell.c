@@ -37,10 +37,9 @@ int shell(char *args[])
 {
 	char cmd[MAXCMDLEN + 1];
 	int i, key, rv;
-	timespec_t t __attribute__((unused));
 	int argnum;
 	char *argval[MAXARGS + 1];
-	pthread_t thr;
+	pid_t thr, done;
 	struct pollfd fds = {0 /* stdin */, POLLRDNORM, 0};
 
 	//printf("\x1b[37m"); /* test escape sequence: white text */
@@ -48,12 +47,15 @@ int shell(char *args[])
 	//printf("\x1b[32m"); /* test escape sequence: green text */
 	help();
 
-	t.tv_sec = 0;
-	t.tv_nsec = 100000000; /* 100 ms */
-
 	while (1)
 	{
 		new_cmd:
+		/* collect background programs that have finished */
+		do {
+			done.ptr = NULL;
+		}
+		while (!waitpid(&done, NULL, WNOHANG) && done.ptr);
+
 		printf("\n> ");
 
 		i = 0;
@@ -62,11 +64,9 @@ int shell(char *args[])
 		/* get command - get chars until new line is received */
 		while (i < MAXCMDLEN)
 		{
-			if (!poll(&fds, 1, 0)) /* is anything pressed? */
-			{
-				nanosleep(&t, NULL);
+			/* block until anything is pressed */
+			if (poll(&fds, 1, -1) < 1)
 				continue;
-			}
 
 			key = getchar();
 			if (!key) /* not ascii? */
@@ -131,7 +131,7 @@ int shell(char *args[])
 		if (!rv)
 		{
 			if (argnum < 2 || argval[argnum-1][0] != '&')
-				pthread_join(thr, NULL);
+				waitpid(&thr, NULL, 0);
 
 			goto new_cmd;
 		}
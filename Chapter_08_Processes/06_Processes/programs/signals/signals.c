@@ -36,12 +36,17 @@ static void *signal_waiting_thread(void *param)
 {
 	sigset_t set;
 	siginfo_t info;
+	timespec_t timeout;
 
 	sigfillset(&set);
 	pthread_sigmask(SIG_BLOCK, &set, NULL);
 
 	printf("Signal waiting thread started\n");
-	sigwaitinfo(&set, &info);
+	timeout.tv_sec = 5;
+	timeout.tv_nsec = 0;
+	while (sigtimedwait(&set, &info, &timeout) == EXIT_FAILURE)
+		printf("Signal waiting thread: no signal in %d seconds\n",
+			 timeout.tv_sec);
 	printf("Signal waiting thread got signal:"
 		 "num=%d, code=%d, errno=%d, si_value=%d\n",
 		 info.si_signo, info.si_code, info.si_errno,
@@ -61,6 +66,9 @@ int signals(char *args[])
 	pthread_t thread;
 	sigval_t sigval;
 	sem_t sem;
+	sigset_t set;
+	siginfo_t info[4];
+	int fd, n;
 
 	printf("Example program: [%s:%s]\n%s\n\n", __FILE__, __FUNCTION__,
 		 PROG_HELP);
@@ -120,6 +128,24 @@ int signals(char *args[])
 
 	pthread_join(thread, NULL);
 
+	/* blocked signals read through descriptor, more at once */
+	sigemptyset(&set);
+	sigaddset(&set, SIGRTMIN);
+	pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+	fd = signalfd(-1, &set, 0);
+	for (i = 0; i < 3; i++)
+	{
+		sigval.sival_int = i;
+		sigqueue(pthread_self(), SIGRTMIN, sigval);
+	}
+
+	n = read(fd, info, sizeof(info));
+	for (i = 0; n > 0 && i < n / sizeof(siginfo_t); i++)
+		printf("Read from signalfd: num=%d, si_value=%d\n",
+			 info[i].si_signo, info[i].si_value.sival_int);
+	close(fd);
+
 	clock_gettime(CLOCK_REALTIME, &t);
 	printf("[END] System time: %d:%d\n", t.tv_sec, t.tv_nsec / 1000000);
 
@@ -0,0 +1,64 @@
+/*! Thread create/join microbenchmark */
+
+#include <stdio.h>
+#include <pthread.h>
+#include <time.h>
+
+char PROG_HELP[] = "Measure pthread_create + pthread_join time: first round "
+		   "uses new thread descriptors and stacks, following rounds "
+		   "reuse cached ones.";
+
+#define THR_NUM	4	/* threads created at once (within THREAD_CACHE_MAX) */
+#define ROUNDS	6
+#define ITERS	25	/* thread groups created and joined in each round */
+
+static void *empty_thread(void *param)
+{
+	return param;
+}
+
+/*! Create and join ITERS groups of THR_NUM threads, return time (in us) */
+static int churn_round()
+{
+	pthread_t thread[THR_NUM];
+	timespec_t t0, t1;
+	int i, j;
+
+	clock_gettime(CLOCK_REALTIME, &t0);
+
+	for (i = 0; i < ITERS; i++)
+	{
+		for (j = 0; j < THR_NUM; j++)
+			if (pthread_create(&thread[j], NULL, empty_thread,
+					     NULL))
+			{
+				printf("Thread not created!\n");
+				break;
+			}
+
+		while (--j >= 0)
+			pthread_join(thread[j], NULL);
+	}
+
+	clock_gettime(CLOCK_REALTIME, &t1);
+	time_sub(&t1, &t0);
+
+	return t1.tv_sec * 1000000 + t1.tv_nsec / 1000;
+}
+
+int thread_churn(char *args[])
+{
+	int round, us;
+
+	printf("Example program: [%s:%s]\n%s\n\n", __FILE__, __FUNCTION__,
+		 PROG_HELP);
+
+	for (round = 1; round <= ROUNDS; round++)
+	{
+		us = churn_round();
+		printf("Round %d: %d threads in %d us (%d us per thread)\n",
+			round, ITERS * THR_NUM, us, us / (ITERS * THR_NUM));
+	}
+
+	return 0;
+}
@@ -1,32 +1,33 @@
 /*! User threads example */
 
-#include "uthread.h"
+#include <uthread.h>
 
 #include <stdio.h>
+#include <time.h>
 
 char PROG_HELP[] = "Threads created and managed in user space - kernel sees"
-		   " only single thread.";
+		   " only few threads (workers) that run them.";
 
 void first (void *param);
 void second(void *param);
 void third (void *param);
-
-volatile static int thr_num;
+void sleeper(void *param);
 
 int user_threads(char *args[])
 {
 	printf("Example program: [%s:%s]\n%s\n\n", __FILE__, __FUNCTION__,
 		 PROG_HELP);
 
-	uthreads_init();
+	uthreads_init(2);
 
 	(void) create_uthread(first, (void *) 1);
 	(void) create_uthread(second, (void *) 2);
 	(void) create_uthread(third, (void *) 3);
-	thr_num = 3;
+	(void) create_uthread(sleeper, (void *) 4);
 
-	while (	thr_num > 0)
-		uthread_yield();
+	uthreads_run();
+
+	printf("All user threads finished\n");
 
 	return 0;
 }
@@ -43,8 +44,6 @@ void first(void *param)
 		uthread_yield();
 	}
 	printf("First thread exiting\n");
-
-	thr_num--;
 }
 
 void second(void *param)
@@ -58,20 +57,36 @@ void second(void *param)
 		uthread_yield();
 	}
 	printf("Second thread exiting\n");
-	thr_num--;
 }
 
+/* busy thread: preempted when its time slice expires */
 void third(void *param)
 {
-	int i;
+	volatile int i, j;
 
 	printf("Third thread starting, param %x\n", param);
 	for (i = 0; i < 3; i++)
 	{
 		printf("Third thread, iter %d\n", i);
-		uthread_yield();
+		for (j = 0; j < 10000000; j++)
+			;
 	}
 	printf("Third thread exiting\n");
+}
+
+/* blocking call: other threads continue on other worker */
+void sleeper(void *param)
+{
+	timespec_t t;
+
+	printf("Sleeping thread starting, param %x\n", param);
+
+	t.tv_sec = 1;
+	t.tv_nsec = 0;
+
+	uthread_block_begin();
+	clock_nanosleep(CLOCK_REALTIME, 0, &t, NULL);
+	uthread_block_end();
 
-	thr_num--;
+	printf("Sleeping thread exiting\n");
 }